@@ -0,0 +1,96 @@
+﻿#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include "Input.h"
+#include "Renderer.h"
+#include "Terminal.h"
+
+//================== Animation Scheduler ==================//
+//------Scheduler-------//
+// Animations are a count of frames and a function that composes frame i and
+// returns how long to hold it. Frames are shown against absolute deadlines,
+// so drawing time never stretches the schedule. A keypress jumps straight to
+// the final frame. Every hold is divided by the global speed factor; a factor
+// of 0 (or output that is not a terminal) shows the final frame at once.
+// Holds are waits on the event loop, so an animation is a Task like a prompt.
+//
+// The speed comes from CASINO_ANIMATION_SPEED or --speed on the command line.
+class Animator {
+public:
+    Animator() {
+        if (const char* env = std::getenv("CASINO_ANIMATION_SPEED")) setSpeed(std::atof(env));
+    }
+
+    void setSpeed(double factor) { speedFactor = factor > 0.0 ? factor : 0.0; }
+    double speed() const { return speedFactor; }
+
+    // drawFrame(FrameBuffer&, int i) composes frame i and returns its hold in ms.
+    // Yields true if the player skipped.
+    template <typename DrawFrame>
+    Task<bool> run(int frameCount, DrawFrame drawFrame) {
+        if (frameCount <= 0) co_return false;
+        Terminal& term = terminal();
+        FrameBuffer& out = frame();
+        const int last = frameCount - 1;
+        bool animate = speedFactor > 0.0 && term.isAnsi();
+        if (animate) {
+            // A final frame taller than the window cannot be redrawn in place
+            (void)drawFrame(out, last);
+            animate = static_cast<size_t>(std::count(out.view().begin(), out.view().end(), '\n')) < Terminal::windowRows();
+            out.clear();
+        }
+        if (!animate) {
+            (void)drawFrame(out, last);
+            term.show(out);
+            term.release();
+            co_return frameCount > 1;
+        }
+
+        bool skipped = false;
+        auto deadline = std::chrono::steady_clock::now();
+        for (int i = 0; i < frameCount; ++i) {
+            deadline += scaled(drawFrame(out, i));
+            term.show(out);
+            const bool key = co_await keyBefore(deadline);
+            if (key) {
+                skipped = true;
+                if (i < last) {
+                    (void)drawFrame(out, last);
+                    term.show(out);
+                }
+                break;
+            }
+        }
+        term.release();
+        co_return skipped;
+    }
+
+    // A still pause the player can cut short; yields true if they did
+    Task<bool> hold(int ms) {
+        if (speedFactor <= 0.0 || !terminal().isAnsi()) co_return true;
+        co_return co_await keyBefore(std::chrono::steady_clock::now() + scaled(ms));
+    }
+
+private:
+    double speedFactor = 1.0;
+
+    // Waits for `deadline`; true early if a key came, with any keys typed after it dropped
+    static Task<bool> keyBefore(std::chrono::steady_clock::time_point deadline) {
+        Keyboard& keys = keyboard();
+        const int key = co_await keys.keyBefore(deadline);
+        if (key == Keyboard::noKey) co_return false;
+        keys.discardTypeahead();
+        co_return true;
+    }
+
+    std::chrono::steady_clock::duration scaled(int ms) const {
+        return std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>(ms / speedFactor));
+    }
+};
+
+// The process-wide animation scheduler
+inline Animator& animator() {
+    static Animator a;
+    return a;
+}
@@ -0,0 +1,381 @@
+﻿#pragma once
+#include "Main.h"
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+
+#if defined(__SSSE3__) || defined(__AVX__)
+#include <tmmintrin.h>
+#define CASINO_BACCARAT_SIMD 1
+#endif
+
+//================== Baccarat Rules ==================//
+//------Card values and the banker third-card rule shared by game and engines-------//
+
+// card logical value (Ace=1, 2-9 numeric, 10/J/Q/K = 0)
+inline int baccaratCardValue(const Card& c) {
+    int r = static_cast<int>(c.getRank());
+    if (r >= (int)Card::Ten && r != (int)Card::Ace) return 0;
+    if (r == (int)Card::Ace) return 1;
+    return r;
+}
+
+// Official-style banker draw decision:
+// Returns true if banker should draw a third card given banker's points and player's third card (or -1 if player didn't draw)
+constexpr bool bankerDrawRule(int bankerPoints, int playerThirdCardValue) {
+    // Player stood: banker draws on 0-5
+    if (playerThirdCardValue < 0) return bankerPoints <= 5;
+    // If banker points 0-2 => draw
+    if (bankerPoints <= 2) return true;
+    // If banker points 3 => draw unless player's third card was 8
+    if (bankerPoints == 3) return playerThirdCardValue != 8;
+    // If banker points 4 => draw if player's third card 2-7
+    if (bankerPoints == 4) return playerThirdCardValue >= 2 && playerThirdCardValue <= 7;
+    // If banker points 5 => draw if player's third card 4-7
+    if (bankerPoints == 5) return playerThirdCardValue >= 4 && playerThirdCardValue <= 7;
+    // If banker points 6 => draw if player's third card 6-7
+    if (bankerPoints == 6) return playerThirdCardValue >= 6 && playerThirdCardValue <= 7;
+    // banker points 7 => stand
+    return false;
+}
+
+//------Drawing tableau: [banker points 0-9][player third card 0-9, or 10 = player stood]-------//
+struct BaccaratTableau {
+    uint8_t draw[10][11];
+};
+
+constexpr BaccaratTableau makeBaccaratTableau() {
+    BaccaratTableau t{};
+    for (int b = 0; b < 10; ++b)
+        for (int p = 0; p <= 10; ++p)
+            t.draw[b][p] = bankerDrawRule(b, p == 10 ? -1 : p) ? 1 : 0;
+    return t;
+}
+
+inline constexpr BaccaratTableau bankerTableau = makeBaccaratTableau();
+
+static_assert(bankerTableau.draw[2][8] == 1 && bankerTableau.draw[3][8] == 0, "tableau: 3 stands on an 8");
+static_assert(bankerTableau.draw[6][6] == 1 && bankerTableau.draw[6][10] == 0, "tableau: 6 draws only on 6-7");
+static_assert(bankerTableau.draw[7][7] == 0 && bankerTableau.draw[5][10] == 1, "tableau: 7 stands, 5 draws when player stood");
+
+inline bool bankerShouldDraw(int bankerPoints, int playerThirdCardValue) {
+    return bankerTableau.draw[bankerPoints][playerThirdCardValue < 0 ? 10 : playerThirdCardValue] != 0;
+}
+
+//------Resolve one coup from the next cards of a shoe (values 0-9, deal order P B P B)-------//
+struct BaccaratCoup {
+    int playerPoints = 0;
+    int bankerPoints = 0;
+    int cardsUsed = 4;
+    int winner = 0; // 0 = Player, 1 = Banker, 2 = Tie
+};
+
+inline BaccaratCoup resolveBaccaratCoup(const uint8_t* next) {
+    BaccaratCoup r;
+    int pp = (next[0] + next[2]) % 10;
+    int bp = (next[1] + next[3]) % 10;
+    if (pp < 8 && bp < 8) {
+        int playerThird = -1;
+        if (pp <= 5) {
+            playerThird = next[r.cardsUsed++];
+            pp = (pp + playerThird) % 10;
+        }
+        if (bankerShouldDraw(bp, playerThird)) bp = (bp + next[r.cardsUsed++]) % 10;
+    }
+    r.playerPoints = pp;
+    r.bankerPoints = bp;
+    r.winner = (pp > bp) ? 0 : (bp > pp) ? 1 : 2;
+    return r;
+}
+
+//================== Shoe Composition ==================//
+//------Remaining card count per baccarat value class (index 0 = tens and faces)-------//
+struct BaccaratShoe {
+    std::array<int, 10> counts{};
+
+    static BaccaratShoe full(int decks) {
+        BaccaratShoe s;
+        for (int v = 1; v <= 9; ++v) s.counts[v] = 4 * decks;
+        s.counts[0] = 16 * decks;
+        return s;
+    }
+    static BaccaratShoe fromDeck(const Deck& deck) {
+        BaccaratShoe s;
+        deck.forEachRemaining([&](const Card& c) { s.counts[baccaratCardValue(c)]++; });
+        return s;
+    }
+
+    int total() const {
+        int t = 0;
+        for (int c : counts) t += c;
+        return t;
+    }
+    void remove(int value) { if (counts[value] > 0) counts[value]--; }
+
+    uint64_t hash() const {
+        uint64_t h = 1469598103934665603ULL; // FNV-1a
+        for (int c : counts) {
+            h ^= static_cast<uint64_t>(c);
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+    bool operator==(const BaccaratShoe& o) const { return counts == o.counts; }
+};
+
+//================== Exact Odds Engine ==================//
+//------Enumerates every 4-6 card coup from a shoe composition-------//
+// Payout multipliers are stake + winnings, matching CasinoManager::processWin.
+// Player/Banker bets push on a tie and a Tie bet loses on anything else, as
+// Baccarat::play settles them; the house pays Banker at 1:1 (no commission).
+struct BaccaratPayouts {
+    double player = 2.0;
+    double banker = 2.0;
+    double tie = 8.0;
+};
+
+struct BaccaratOdds {
+    double player = 0.0;
+    double banker = 0.0;
+    double tie = 0.0;
+    double evPlayer = 0.0; // expected net return per unit staked
+    double evBanker = 0.0;
+    double evTie = 0.0;
+};
+
+class BaccaratOddsEngine {
+public:
+    explicit BaccaratOddsEngine(BaccaratPayouts pay = BaccaratPayouts(), size_t maxCached = 4096)
+        : payouts(pay), cacheLimit(maxCached) {
+    }
+
+    // Exact odds for the next coup dealt from `shoe`. Cached by composition, which only
+    // hits when a shoe repeats (a fresh shoe); a miss is a full enumeration.
+    const BaccaratOdds& query(const BaccaratShoe& shoe) {
+        const uint64_t key = shoe.hash();
+        auto it = cache.find(key);
+        if (it != cache.end() && it->second.shoe == shoe) { ++hits; return it->second.odds; }
+
+        if (cache.size() >= cacheLimit) cache.clear();
+        Entry& e = cache[key];
+        e.shoe = shoe;
+        e.odds = enumerate(shoe);
+        ++misses;
+        return e.odds;
+    }
+
+    uint64_t cacheHits() const { return hits; }
+    uint64_t cacheMisses() const { return misses; }
+    const BaccaratPayouts& payoutTable() const { return payouts; }
+
+private:
+    struct Entry {
+        BaccaratShoe shoe;
+        BaccaratOdds odds;
+    };
+
+    BaccaratPayouts payouts;
+    size_t cacheLimit;
+    std::unordered_map<uint64_t, Entry> cache;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+
+    // Deal order is P1 B1 P2 B2 [P3] [B3]. The opening four cards are exchangeable, so
+    // each side's pair is enumerated unordered and weighted by its number of orderings.
+    // The banker's third card only matters through the banker's final total, so its ten
+    // branches collapse to three lookups in a running count of totals below each point.
+    BaccaratOdds enumerate(const BaccaratShoe& shoe) const {
+        std::array<int, 10> c = shoe.counts;
+        const int cards = shoe.total();
+        const double n = static_cast<double>(cards);
+        double pw = 0.0, bw = 0.0, tw = 0.0;
+
+        auto score = [&](int p, int b, double w) {
+            if (p > b) pw += w;
+            else if (b > p) bw += w;
+            else tw += w;
+        };
+
+        if (n < 6) {
+            BaccaratOdds empty;
+            return empty;
+        }
+
+        const double opening = 1.0 / (n * (n - 1) * (n - 2) * (n - 3));
+        const int left = cards - 4;
+        for (int p1 = 0; p1 < 10; ++p1) {
+            if (!c[p1]) continue;
+            const double w1 = c[p1]; c[p1]--;
+            for (int p2 = p1; p2 < 10; ++p2) {
+                if (!c[p2]) continue;
+                const double w2 = w1 * c[p2] * (p1 == p2 ? 1 : 2); c[p2]--;
+                for (int b1 = 0; b1 < 10; ++b1) {
+                    if (!c[b1]) continue;
+                    const double w3 = w2 * c[b1]; c[b1]--;
+                    for (int b2 = b1; b2 < 10; ++b2) {
+                        if (!c[b2]) continue;
+                        const double w4 = w3 * c[b2] * (b1 == b2 ? 1 : 2) * opening; c[b2]--;
+                        const int pp = (p1 + p2) % 10;
+                        const int bp = (b1 + b2) % 10;
+
+                        if (pp >= 8 || bp >= 8) score(pp, bp, w4); // natural
+                        else if (pp <= 5 || bankerShouldDraw(bp, -1)) {
+                            // at[t]: cards that would leave the banker on t; below[t]: on less than t
+                            int at[10], below[11];
+                            below[0] = 0;
+                            for (int t = 0; t < 10; ++t) {
+                                at[t] = c[(t + 10 - bp) % 10];
+                                below[t + 1] = below[t] + at[t];
+                            }
+                            if (pp <= 5) {
+                                for (int p3 = 0; p3 < 10; ++p3) {
+                                    if (!c[p3]) continue;
+                                    const double w5 = w4 * c[p3] / (n - 4);
+                                    const int pf = (pp + p3) % 10;
+                                    if (bankerShouldDraw(bp, p3)) {
+                                        const int gone = (bp + p3) % 10; // banker total the player's card would have made
+                                        const int lower = below[pf] - (gone < pf);
+                                        const int same = at[pf] - (gone == pf);
+                                        const double w6 = w5 / (n - 5);
+                                        pw += w6 * lower;
+                                        tw += w6 * same;
+                                        bw += w6 * (left - 1 - lower - same);
+                                    }
+                                    else score(pf, bp, w5);
+                                }
+                            }
+                            else {
+                                const double w5 = w4 / (n - 4);
+                                pw += w5 * below[pp];
+                                tw += w5 * at[pp];
+                                bw += w5 * (left - below[pp] - at[pp]);
+                            }
+                        }
+                        else score(pp, bp, w4);
+                        c[b2]++;
+                    }
+                    c[b1]++;
+                }
+                c[p2]++;
+            }
+            c[p1]++;
+        }
+
+        BaccaratOdds o;
+        o.player = pw;
+        o.banker = bw;
+        o.tie = tw;
+        o.evPlayer = pw * payouts.player + tw - 1.0;
+        o.evBanker = bw * payouts.banker + tw - 1.0;
+        o.evTie = tw * payouts.tie - 1.0;
+        return o;
+    }
+};
+
+//================== Batched Coup Kernel ==================//
+//------Resolves one coup per lane for many independent shoes at once-------//
+// Input is structure-of-arrays: cards[k][lane] is the k-th next card (value 0-9)
+// of the shoe in that lane, in deal order P B P B followed by up to two draws.
+// Every lane runs the same instruction stream; draws are selects, not branches.
+// cardsUsed (4-6) tells each shoe how far to advance.
+struct BaccaratBatch {
+    const uint8_t* cards[6];
+    uint8_t* winner;        // 0 = Player, 1 = Banker, 2 = Tie
+    uint8_t* playerPoints;
+    uint8_t* bankerPoints;
+    uint8_t* cardsUsed;
+};
+
+inline void resolveBaccaratLanesScalar(const BaccaratBatch& b, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+        const unsigned c4 = b.cards[4][i];
+        const unsigned c5 = b.cards[5][i];
+        unsigned pp = b.cards[0][i] + b.cards[2][i]; pp -= 10u * (pp >= 10u);
+        unsigned bp = b.cards[1][i] + b.cards[3][i]; bp -= 10u * (bp >= 10u);
+
+        const unsigned live = (pp < 8u) & (bp < 8u);
+        const unsigned pDraw = live & (pp <= 5u);
+        const unsigned p3 = pDraw ? c4 : 10u;
+        const unsigned bDraw = live & bankerTableau.draw[bp][p3];
+        const unsigned b3 = pDraw ? c5 : c4;
+
+        pp += pDraw * c4; pp -= 10u * (pp >= 10u);
+        bp += bDraw * b3; bp -= 10u * (bp >= 10u);
+
+        b.winner[i] = static_cast<uint8_t>((pp < bp) + 2u * (pp == bp));
+        b.playerPoints[i] = static_cast<uint8_t>(pp);
+        b.bankerPoints[i] = static_cast<uint8_t>(bp);
+        b.cardsUsed[i] = static_cast<uint8_t>(4u + pDraw + bDraw);
+    }
+}
+
+#ifdef CASINO_BACCARAT_SIMD
+// Tableau rows as 16-byte lookup masks, indexed by the player third card (10 = stood)
+struct BaccaratTableauMasks {
+    alignas(16) uint8_t row[10][16];
+};
+
+constexpr BaccaratTableauMasks makeBaccaratTableauMasks() {
+    BaccaratTableauMasks m{};
+    for (int b = 0; b < 10; ++b)
+        for (int p = 0; p <= 10; ++p)
+            m.row[b][p] = bankerTableau.draw[b][p] ? 0xFF : 0x00;
+    return m;
+}
+
+inline constexpr BaccaratTableauMasks bankerTableauMasks = makeBaccaratTableauMasks();
+
+// 16 coups per iteration; returns how many lanes were resolved
+inline size_t resolveBaccaratLanesSimd(const BaccaratBatch& b, size_t lanes) {
+    const __m128i nine = _mm_set1_epi8(9);
+    const __m128i ten = _mm_set1_epi8(10);
+    const __m128i seven = _mm_set1_epi8(7);
+    const __m128i six = _mm_set1_epi8(6);
+    const __m128i four = _mm_set1_epi8(4);
+    const __m128i one = _mm_set1_epi8(1);
+    const __m128i two = _mm_set1_epi8(2);
+    auto mod10 = [&](__m128i x) { return _mm_sub_epi8(x, _mm_and_si128(_mm_cmpgt_epi8(x, nine), ten)); };
+    auto select = [](__m128i mask, __m128i a, __m128i b) { return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b)); };
+
+    __m128i rows[10];
+    for (int r = 0; r < 10; ++r) rows[r] = _mm_load_si128(reinterpret_cast<const __m128i*>(bankerTableauMasks.row[r]));
+
+    size_t i = 0;
+    for (; i + 16 <= lanes; i += 16) {
+        __m128i c[6];
+        for (int k = 0; k < 6; ++k) c[k] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b.cards[k] + i));
+
+        __m128i pp = mod10(_mm_add_epi8(c[0], c[2]));
+        __m128i bp = mod10(_mm_add_epi8(c[1], c[3]));
+        const __m128i natural = _mm_or_si128(_mm_cmpgt_epi8(pp, seven), _mm_cmpgt_epi8(bp, seven));
+        const __m128i pDraw = _mm_andnot_si128(natural, _mm_cmpgt_epi8(six, pp));
+        const __m128i p3 = select(pDraw, c[4], ten);
+
+        __m128i tableau = _mm_setzero_si128();
+        for (int r = 0; r < 10; ++r)
+            tableau = _mm_or_si128(tableau, _mm_and_si128(_mm_cmpeq_epi8(bp, _mm_set1_epi8(static_cast<char>(r))), _mm_shuffle_epi8(rows[r], p3)));
+        const __m128i bDraw = _mm_andnot_si128(natural, tableau);
+        const __m128i b3 = select(pDraw, c[5], c[4]);
+
+        pp = mod10(_mm_add_epi8(pp, _mm_and_si128(pDraw, c[4])));
+        bp = mod10(_mm_add_epi8(bp, _mm_and_si128(bDraw, b3)));
+
+        const __m128i winner = _mm_or_si128(_mm_and_si128(_mm_cmpgt_epi8(bp, pp), one), _mm_and_si128(_mm_cmpeq_epi8(bp, pp), two));
+        const __m128i used = _mm_sub_epi8(_mm_sub_epi8(four, pDraw), bDraw); // masks are -1
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(b.winner + i), winner);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(b.playerPoints + i), pp);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(b.bankerPoints + i), bp);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(b.cardsUsed + i), used);
+    }
+    return i;
+}
+#endif
+
+inline void resolveBaccaratBatch(const BaccaratBatch& b, size_t lanes) {
+    size_t done = 0;
+#ifdef CASINO_BACCARAT_SIMD
+    done = resolveBaccaratLanesSimd(b, lanes);
+#endif
+    resolveBaccaratLanesScalar(b, done, lanes);
+}
@@ -0,0 +1,217 @@
+﻿#pragma once
+#include "Main.h"
+#include <array>
+#include <cstdint>
+
+//================== Baccarat Coup Record ==================//
+//------One coup packed into 16 bits-------//
+// bits 0-1 winner (0 Player, 1 Banker, 2 Tie), bit 2 player pair, bit 3 banker pair,
+// bit 4 natural, bits 5-8 player points, bits 9-12 banker points
+struct CoupRecord {
+    uint16_t bits = 0;
+
+    static CoupRecord make(int winner, bool playerPair, bool bankerPair, bool natural, int playerPoints, int bankerPoints) {
+        CoupRecord r;
+        r.bits = static_cast<uint16_t>((winner & 3) | (playerPair << 2) | (bankerPair << 3) | (natural << 4)
+            | ((playerPoints & 15) << 5) | ((bankerPoints & 15) << 9));
+        return r;
+    }
+    int winner() const { return bits & 3; }
+    bool playerPair() const { return (bits >> 2) & 1; }
+    bool bankerPair() const { return (bits >> 3) & 1; }
+    bool natural() const { return (bits >> 4) & 1; }
+    int playerPoints() const { return (bits >> 5) & 15; }
+    int bankerPoints() const { return (bits >> 9) & 15; }
+};
+
+//================== Fixed-Size Ring ==================//
+//------Keeps the newest N items; index 0 is the oldest still held-------//
+template <typename T, size_t N>
+class RingBuffer {
+    static_assert((N & (N - 1)) == 0, "RingBuffer capacity must be a power of two");
+public:
+    void clear() { head = 0; count = 0; }
+    void push(const T& v) {
+        items[head & (N - 1)] = v;
+        ++head;
+        if (count < N) ++count;
+    }
+    size_t size() const { return count; }
+    static constexpr size_t capacity() { return N; }
+    uint64_t pushed() const { return head; }
+
+    // i-th oldest held item
+    const T& operator[](size_t i) const { return items[(head - count + i) & (N - 1)]; }
+    T& back() { return items[(head - 1) & (N - 1)]; }
+    const T& back() const { return items[(head - 1) & (N - 1)]; }
+    // Column `absolute` counted from the start (must still be held)
+    const T& atAbsolute(uint64_t absolute) const { return items[absolute & (N - 1)]; }
+    bool holds(uint64_t absolute) const { return absolute < head && head - absolute <= count; }
+
+private:
+    std::array<T, N> items{};
+    uint64_t head = 0;
+    size_t count = 0;
+};
+
+//================== Scoreboard Roads ==================//
+//------Bead plate, big road and the three derived roads, updated per coup-------//
+// Every road keeps only its newest columns, so memory stays fixed however long a
+// simulated shoe runs. record() touches a constant number of columns.
+class BaccaratScoreboard {
+public:
+    static constexpr int rows = 6;
+
+    struct Stats {
+        uint64_t coups = 0;
+        uint64_t wins[3] = { 0, 0, 0 }; // Player, Banker, Tie
+        uint64_t playerPairs = 0;
+        uint64_t bankerPairs = 0;
+        uint64_t naturals = 0;
+        int streakSide = -1;            // side of the current streak (ties don't break it)
+        uint32_t streak = 0;
+        uint32_t longestStreak[2] = { 0, 0 };
+    };
+
+    void newShoe() {
+        beads.clear();
+        bigRoad.clear();
+        for (auto& d : derived) d.clear();
+        leadingTies = 0;
+        stats = Stats();
+    }
+
+    void record(int winner, bool playerPair, bool bankerPair, bool natural, int playerPoints, int bankerPoints) {
+        beads.push(CoupRecord::make(winner, playerPair, bankerPair, natural, playerPoints, bankerPoints));
+
+        ++stats.coups;
+        ++stats.wins[winner];
+        stats.playerPairs += playerPair;
+        stats.bankerPairs += bankerPair;
+        stats.naturals += natural;
+
+        if (winner == 2) {
+            // Ties are marked on the latest big road cell rather than taking one
+            if (bigRoad.size() == 0) ++leadingTies;
+            else bigRoad.back().tieMask |= static_cast<uint16_t>(1u << std::min<uint32_t>(bigRoad.back().length - 1, 15));
+            return;
+        }
+
+        if (winner == stats.streakSide) ++stats.streak;
+        else { stats.streakSide = winner; stats.streak = 1; }
+        stats.longestStreak[winner] = std::max(stats.longestStreak[winner], stats.streak);
+
+        uint32_t row = 0;
+        if (bigRoad.size() > 0 && bigRoad.back().side == winner) row = bigRoad.back().length++;
+        else bigRoad.push(Column{ static_cast<uint8_t>(winner), 1, 0 });
+
+        const uint64_t col = bigRoad.pushed() - 1;
+        for (int k = 1; k <= 3; ++k) extendDerived(k, col, row);
+    }
+
+    const Stats& statistics() const { return stats; }
+
+    // Whole scoreboard as one string; callers write it in a single call
+    std::string render(int width = 24) const {
+        std::string out;
+        out.reserve(static_cast<size_t>(width) * 4 * rows * 5 + 512);
+
+        out += "BEAD PLATE\n";
+        renderBeads(out, width);
+        out += "BIG ROAD (lowercase = tie on that cell";
+        if (leadingTies) out += ", " + std::to_string(leadingTies) + " opening tie(s)";
+        out += ")\n";
+        renderColumns(out, bigRoad, width, true);
+
+        static const char* names[3] = { "BIG EYE BOY", "SMALL ROAD", "COCKROACH PIG" };
+        for (int k = 0; k < 3; ++k) {
+            out += names[k];
+            out += u8" (● red  ○ blue)\n";
+            renderColumns(out, derived[k], width, false);
+        }
+
+        out += "P " + std::to_string(stats.wins[0]) + "  B " + std::to_string(stats.wins[1])
+            + "  T " + std::to_string(stats.wins[2]) + "  | P pairs " + std::to_string(stats.playerPairs)
+            + "  B pairs " + std::to_string(stats.bankerPairs) + "  naturals " + std::to_string(stats.naturals) + "\n";
+        out += "Streak: ";
+        out += stats.streakSide < 0 ? "-" : std::to_string(stats.streak) + (stats.streakSide == 0 ? " Player" : " Banker");
+        out += "  | Longest P " + std::to_string(stats.longestStreak[0]) + "  B " + std::to_string(stats.longestStreak[1]) + "\n";
+        return out;
+    }
+
+    void show(int width = 24) const {
+        const std::string s = render(width);
+        std::cout.write(s.data(), static_cast<std::streamsize>(s.size()));
+        std::cout.flush();
+    }
+
+private:
+    struct Column {
+        uint8_t side = 0;     // big road: 0 Player / 1 Banker; derived: 0 red / 1 blue
+        uint32_t length = 0;
+        uint16_t tieMask = 0; // big road only: bit r = tie(s) after row r
+    };
+
+    static constexpr size_t beadCapacity = 1024;
+    static constexpr size_t columnCapacity = 64;
+
+    RingBuffer<CoupRecord, beadCapacity> beads;
+    RingBuffer<Column, columnCapacity> bigRoad;
+    RingBuffer<Column, columnCapacity> derived[3];
+    uint32_t leadingTies = 0;
+    Stats stats;
+
+    uint32_t bigRoadLength(uint64_t col) const { return bigRoad.atAbsolute(col).length; }
+
+    // Derived road k compares the new big road cell with column col-k (same row),
+    // or for a new column, the lengths of columns col-1 and col-1-k.
+    void extendDerived(int k, uint64_t col, uint32_t row) {
+        int color; // 0 red, 1 blue
+        if (row == 0) {
+            if (col < static_cast<uint64_t>(k) + 1) return;
+            color = (bigRoadLength(col - 1) == bigRoadLength(col - 1 - k)) ? 0 : 1;
+        }
+        else {
+            if (col < static_cast<uint64_t>(k)) return;
+            color = (bigRoadLength(col - k) == row) ? 1 : 0;
+        }
+        auto& road = derived[k - 1];
+        if (road.size() > 0 && road.back().side == color) ++road.back().length;
+        else road.push(Column{ static_cast<uint8_t>(color), 1, 0 });
+    }
+
+    void renderBeads(std::string& out, int width) const {
+        const uint64_t total = beads.pushed();
+        const uint64_t totalCols = (total + rows - 1) / rows;
+        const uint64_t firstCol = totalCols > static_cast<uint64_t>(width) ? totalCols - width : 0;
+        for (int r = 0; r < rows; ++r) {
+            for (uint64_t c = firstCol; c < totalCols; ++c) {
+                const uint64_t i = c * rows + r;
+                out += beads.holds(i) ? "PBT"[beads.atAbsolute(i).winner()] : '.';
+                out += ' ';
+            }
+            out += '\n';
+        }
+    }
+
+    void renderColumns(std::string& out, const RingBuffer<Column, columnCapacity>& road, int width, bool bigRoadCells) const {
+        const size_t cols = road.size();
+        const size_t first = cols > static_cast<size_t>(width) ? cols - width : 0;
+        for (int r = 0; r < rows; ++r) {
+            for (size_t c = first; c < cols; ++c) {
+                const Column& col = road[c];
+                const bool filled = col.length > static_cast<uint32_t>(r);
+                const bool overflow = (r == rows - 1) && col.length > static_cast<uint32_t>(rows);
+                if (!filled) out += '.';
+                else if (overflow) out += '+';
+                else if (bigRoadCells) {
+                    const bool tie = (col.tieMask >> r) & 1;
+                    out += tie ? "pb"[col.side] : "PB"[col.side];
+                }
+                else out += col.side == 0 ? u8"●" : u8"○";
+                out += ' ';
+            }
+            out += '\n';
+        }
+    }
+};
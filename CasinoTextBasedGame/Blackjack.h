@@ -1,5 +1,8 @@
 ﻿#pragma once
 #include "Main.h"
+#include "BlackjackRules.h"
+#include "GameRegistry.h"
+#include "View.h"
 
 
 //================== Hand Definition ==================//
@@ -11,6 +14,8 @@ public:
 		cards.push_back(card);
 	}
 	int getValue() const {
+		PhaseTimer timing(Phase::Evaluate);
+		countMetric(Counter::EvaluatorCalls);
 		int total = 0;
 		int aceCount = 0;
 		for (const auto& card : cards) {
@@ -25,6 +30,24 @@ public:
 		}
 		return total;
 	}
+	int hardValue() const {
+		int total = 0;
+		for (const auto& card : cards) {
+			total += (card.getRank() == Card::Ace) ? 1 : card.getValue();
+		}
+		return total;
+	}
+	int aceCount() const {
+		int count = 0;
+		for (const auto& card : cards) {
+			if (card.getRank() == Card::Ace) count++;
+		}
+		return count;
+	}
+	// Soft = an ace is still being counted as 11
+	bool isSoft() const {
+		return aceCount() > 0 && hardValue() <= 11;
+	}
 	bool isBust() const {
 		return getValue() > 21;
 	}
@@ -50,42 +73,48 @@ public:
 		cards.clear();
 	}
 	void displayHand(bool hideFirstCard = false) const {
-		std::vector<std::vector<std::string>> cardLines;
-		for (size_t i = 0; i < cards.size(); ++i) {
-			if (i == 0 && hideFirstCard) {
-				cardLines.push_back(Card::hiddenCard());
-			}
-			else {
-				cardLines.push_back(cards[i].displayCard());
-			}
-		}
-		for (size_t line = 0; line < 7; ++line) {
-			for (const auto& card : cardLines) {
-				std::cout << card[line] << " ";
-			}
-			std::cout << std::endl;
-		}
+		displayHand(frame(), hideFirstCard);
+		frame().present();
+	}
+	void displayHand(FrameBuffer& out, bool hideFirstCard = false) const {
+		drawCardRow(out, cards, hideFirstCard);
 	}
 };
 
 //================== Game Definition ==================//
 //------game class representing the games logic-------//
-class Blackjack {
+// Rules is one of the policies in BlackjackRules.h; see the Blackjack alias below.
+// View is ConsoleView or NullView (View.h).
+template <typename Rules, typename View = ConsoleView>
+class BasicBlackjack {
 private:
-    Deck deck;
+    using Kernel = BlackjackKernel<Rules>;
+
+    View view;
+
+    Deck deck{ Rules::decks };
     Hand playerHand;
     Hand dealerHand;
     double currentBet = 0;
+    bool doubled = false;
+    bool surrendered = false;
     Player* playerRef = nullptr;
     CasinoManager* casinoRef = nullptr;
     bool revealDealerCard = false;
     bool forceTenNext = false;
     bool negateNextCurse = false;
 public:
-    void startNewRound() {
+    Task<void> startNewRound() {
         playerHand.clear();
         dealerHand.clear();
-        deck.shuffle();
+        doubled = false;
+        surrendered = false;
+
+        // Shoe is only reshuffled once the cut card comes out
+        if (deck.size() - deck.remaining() >= static_cast<size_t>(Kernel::cutCard)) {
+            deck.shuffle();
+            view.box("Cut card reached. The dealer shuffles the shoe.");
+        }
 
         Player& p = *playerRef;
 		CasinoManager& casino = *casinoRef;
@@ -95,34 +124,50 @@ public:
         dealerHand.addCard(dealCardWithFantasy());
         playerHand.addCard(dealCardWithFantasy());
         dealerHand.addCard(dealCardWithFantasy());
-        offerBlessings();
+        co_await offerBlessings();
 
         // ----- Betting -----
         currentBet;
-        casino.placeBet(currentBet);
+        co_await casino.placeBet(currentBet, 10, 1000, View::enabled);
     }
 
-    void play(Player &player, CasinoManager &casino) {
+    Task<void> play(Player &player, CasinoManager &casino) {
+        TraceSpan span("Blackjack::play", Rules::name);
         playerRef = &player;
 		casinoRef = &casino;
 
-        startNewRound();
-        
+        co_await startNewRound();
+
+        // Naturals are settled before anyone acts
+        if (playerHand.isBlackjack() || dealerHand.isBlackjack()) {
+            showHands(false);
+            if (playerHand.isBlackjack() && dealerHand.isBlackjack()) co_return finalizeRound(false, true);
+            if (playerHand.isBlackjack()) {
+                view.box("Blackjack!");
+                co_return finalizeRound(true, false, true);
+            }
+            view.box("Dealer has Blackjack!");
+            co_return finalizeRound(false);
+        }
 
         // Player turn
-        playerTurn();
+        co_await playerTurn();
+        if (surrendered) {
+            showHands(false);
+            co_return finalizeRound(false);
+        }
         if (playerHand.isBust()) {
             showHands(false);
-            drawAsciiBox("Player busts! Dealer wins!\n");
-            return finalizeRound(false);
+            view.box("Player busts! Dealer wins!\n");
+            co_return finalizeRound(false);
         }
 
         // Dealer turn
         dealerTurn();
         if (dealerHand.isBust()) {
             showHands(false);
-            drawAsciiBox("Dealer busts! Player wins!\n");
-            return finalizeRound(true);
+            view.box("Dealer busts! Player wins!\n");
+            co_return finalizeRound(true);
         }
 
         showHands(false);
@@ -138,22 +183,20 @@ public:
     }
 
 private:
-    void offerBlessings() {
+    Task<void> offerBlessings() {
         Player& p = *playerRef;
 
-        std::cout << "\nWould you like to use a Blessing?\n";
-        std::cout << "1. Fate's Glimpse (15 mana)\n";
-        std::cout << "2. Lucky Draw   (20 mana)\n";
-        std::cout << "3. Mana Shield  (10 mana)\n";
-        std::cout << "4. None\n> ";
-
-        int c;
-        std::cin >> c;
+        view.print("\nWould you like to use a Blessing?\n"
+            "1. Fate's Glimpse (15 mana)\n"
+            "2. Lucky Draw   (20 mana)\n"
+            "3. Mana Shield  (10 mana)\n"
+            "4. None\n");
 
-        switch (c) {
-        case 1: p.castBlessing("Fate's Glimpse"); break;
-        case 2: p.castBlessing("Lucky Draw"); break;
-        case 3: p.castBlessing("Mana Shield"); break;
+        const int pick = co_await casinoRef->input.readChoice("> ", 1, 4);
+        switch (pick) {
+        case 1: p.castBlessing("Fate's Glimpse", View::enabled); break;
+        case 2: p.castBlessing("Lucky Draw", View::enabled); break;
+        case 3: p.castBlessing("Mana Shield", View::enabled); break;
         }
     }
     Card dealCardWithFantasy() {
@@ -162,99 +205,145 @@ private:
         // handle Lucky Draw
         if (shouldForceTen()) {
             p.clearBlessings();
-            return Card(Card::Ten, (Card::Suit)(rand() % 4));
+            const Card ten(Card::Ten, (Card::Suit)randint(0, 3));
+            recordEvent(EventType::CardDealt, static_cast<uint8_t>(ten.atlasIndex()));
+            return ten;
         }
 
         return deck.dealCard();
     }
     void showHands(bool hideDealerFirstCard) const {
-        Player& p = *playerRef;
-
-        std::cout << "\nDealer's Hand:\n";
-
         if (shouldRevealDealer() == true)
             hideDealerFirstCard = false;
 
-        dealerHand.displayHand(hideDealerFirstCard);
+        view.draw([&](FrameBuffer& out) {
+            out << "\nDealer's Hand:\n";
+            dealerHand.displayHand(out, hideDealerFirstCard);
 
-        if (!hideDealerFirstCard)
-            std::cout << "Value: " << dealerHand.getValue() << "\n";
+            if (!hideDealerFirstCard)
+                out << "Value: " << dealerHand.getValue() << "\n";
 
-        std::cout << "\nPlayer's Hand:\n";
-        playerHand.displayHand();
-        std::cout << "Value: " << playerHand.getValue() << "\n";
+            out << "\nPlayer's Hand:\n";
+            playerHand.displayHand(out);
+            out << "Value: " << playerHand.getValue() << "\n";
+        });
     }
 
-    void playerTurn() {
-        char choice;
+    // Hit and stand always; double and surrender only when the rules allow them now
+    static const KeyMap& turnKeys(bool canDouble, bool canSurrender) {
+        static const std::array<KeyMap, 4> keys = [] {
+            std::array<KeyMap, 4> k;
+            for (int i = 0; i < 4; ++i) {
+                k[i].bind('h', Action::Hit).bind('s', Action::Stand);
+                if (i & 1) k[i].bind('d', Action::Double);
+                if (i & 2) k[i].bind('r', Action::Surrender);
+            }
+            return k;
+        }();
+        return keys[(canDouble ? 1 : 0) | (canSurrender ? 2 : 0)];
+    }
+    static const char* turnPrompt(bool canDouble, bool canSurrender) {
+        static const char* const prompts[4] = {
+            "Do you want to (h)it or (s)tand? ",
+            "Do you want to (h)it or (s)tand, (d)ouble? ",
+            "Do you want to (h)it or (s)tand, su(r)render? ",
+            "Do you want to (h)it or (s)tand, (d)ouble, su(r)render? ",
+        };
+        return prompts[(canDouble ? 1 : 0) | (canSurrender ? 2 : 0)];
+    }
+
+    Task<void> playerTurn() {
+        Player& p = *playerRef;
+        Action choice;
         do {
             showHands(true);
-            std::cout << "Do you want to (h)it or (s)tand? ";
-            std::cin >> choice;
-            if (choice == 'h' || choice == 'H') {
+            const bool canDouble = Kernel::canDouble(playerHand.cards.size(), false) && p.canCover(currentBet);
+            const bool canSurrender = Kernel::canSurrender(playerHand.cards.size(), false);
+            choice = co_await casinoRef->input.readAction(turnPrompt(canDouble, canSurrender), turnKeys(canDouble, canSurrender));
+            if (choice == Action::Hit) {
                 playerHand.addCard(deck.dealCard());
                 if (playerHand.isBust()) {
                     showHands(false);
-                    return;
+                    co_return;
                 }
             }
-            if (choice != 'h' && choice != 'H' && choice != 's' && choice != 'S') {
-                std::cerr << "[!] ERROR: Invalid choice. Please enter 'h' to hit or 's' to stand.\n";
+            else if (choice == Action::Double) {
+                p.placeBet(currentBet);
+                currentBet *= 2;
+                doubled = true;
+                view.box(u8"Doubled down. Total bet: £", Fixed{ currentBet });
+                playerHand.addCard(deck.dealCard());
+                co_return;
+            }
+            else if (choice == Action::Surrender) {
+                surrendered = true;
+                co_return;
             }
 
             if (playerHand.canSplit()) {
-                char splitChoice;
-                std::cout << "You have a pair! Do you want to split? (y/n): ";
-                std::cin >> splitChoice;
-                if (splitChoice == 'y' || splitChoice == 'Y') {
+                const bool split = co_await casinoRef->input.readYesNo("You have a pair! Do you want to split? (y/n): ");
+                if (split) {
                     Hand newHand;
                     playerHand.split(newHand);
                     playerHand.addCard(deck.dealCard());
                     newHand.addCard(deck.dealCard());
-                    std::cout << "First Hand:\n";
-                    playerHand.displayHand();
-                    std::cout << "Second Hand:\n";
-                    newHand.displayHand();
+                    view.draw([&](FrameBuffer& out) {
+                        out << "First Hand:\n";
+                        playerHand.displayHand(out);
+                        out << "Second Hand:\n";
+                        newHand.displayHand(out);
+                    });
                 }
             }
-        } while (choice != 's' && choice != 'S');
+        } while (choice != Action::Stand);
     }
 
     void dealerTurn() {
-        std::cout << "\nDealer's turn...\n";
+        TraceSpan span("Blackjack::dealerTurn");
+        view.print("\nDealer's turn...\n");
         showHands(true);
-        while (dealerHand.getValue() < 17) {
+        while (Kernel::dealerHits(dealerHand.getValue(), dealerHand.isSoft())) {
             dealerHand.addCard(deck.dealCard());
         }
     }
 
-    void finalizeRound(bool playerWon, bool push = false) {
+    void finalizeRound(bool playerWon, bool push = false, bool natural = false) {
         Player& p = *playerRef;
 		CasinoManager& casino = *casinoRef;
 
         if (push) {
-            drawAsciiBox("Push! You get your bet back.");
-            casino.processWin(currentBet);
+            view.box("Push! You get your bet back.");
+            casino.processWin(currentBet, Kernel::pushMultiplier, View::enabled);
         }
         else if (playerWon) {
-            drawAsciiBox("You win!");
-			casino.processWin(currentBet, 2);
+            view.box("You win!");
+			casino.processWin(currentBet, natural ? Kernel::blackjackMultiplier : Kernel::winMultiplier, View::enabled);
+        }
+        else if (surrendered) {
+            const double refund = currentBet * Kernel::surrenderRefund;
+            view.box("You surrender half your bet.");
+            p.payWin(refund);
+            casino.processLoss(currentBet - refund, View::enabled);
         }
         else {
-            drawAsciiBox("You lose...");
+            view.box("You lose...");
             // chance to receive a curse
-            if (rand() % 100 < 35) {
-                p.applyCurse("Muddled Sight", 2);
-                drawAsciiBox("A dark curse afflicts you: Muddled Sight!");
+            if (randint(0, 99) < 35) {
+                p.applyCurse("Muddled Sight", 2, View::enabled);
+                view.box("A dark curse afflicts you: Muddled Sight!");
             }
-			casino.processLoss(currentBet);
+			casino.processLoss(currentBet, View::enabled);
         }
 
         p.regenerateMana();
         p.clearBlessings();
-        p.decayCurses();
+        p.decayCurses(View::enabled);
     }
     bool shouldRevealDealer() const { return revealDealerCard; }
     bool shouldForceTen() const { return forceTenNext; }
     bool shouldNegateCurse() const { return negateNextCurse; }
 };
+
+// The house table; other policies from BlackjackRules.h instantiate the same game
+using Blackjack = BasicBlackjack<ClassicRules>;
+inline const bool blackjackRegistered = registerGame<Blackjack, BasicBlackjack<ClassicRules, NullView>>({ "Blackjack", "Blackjack", 1, KeepsShoe | Blessings });
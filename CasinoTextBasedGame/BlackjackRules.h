@@ -0,0 +1,275 @@
+﻿#pragma once
+#include "Main.h"
+#include "JobScheduler.h"
+#include <cstdint>
+
+//================== Blackjack Rule Policies ==================//
+//------Compile-time rule bundles for BasicBlackjack / the simulator-------//
+// A policy is a struct of constants only. Every rule check in the kernel below
+// is a constexpr expression on these, so each variant is its own instantiation
+// and the checks fold away instead of being tested per hand.
+struct ClassicRules {
+    static constexpr const char* name = "Classic (1 deck, S17, BJ 1:1)";
+    static constexpr int  decks = 1;
+    static constexpr bool hitSoft17 = false;
+    static constexpr bool doubleDown = false;
+    static constexpr bool doubleAfterSplit = false;
+    static constexpr bool lateSurrender = false;
+    static constexpr int  blackjackPayNum = 1; // natural pays 1:1
+    static constexpr int  blackjackPayDen = 1;
+};
+
+struct VegasStripRules {
+    static constexpr const char* name = "Vegas Strip (4 decks, S17, DAS, 3:2, LS)";
+    static constexpr int  decks = 4;
+    static constexpr bool hitSoft17 = false;
+    static constexpr bool doubleDown = true;
+    static constexpr bool doubleAfterSplit = true;
+    static constexpr bool lateSurrender = true;
+    static constexpr int  blackjackPayNum = 3;
+    static constexpr int  blackjackPayDen = 2;
+};
+
+struct DowntownRules {
+    static constexpr const char* name = "Downtown (2 decks, H17, DAS, 3:2)";
+    static constexpr int  decks = 2;
+    static constexpr bool hitSoft17 = true;
+    static constexpr bool doubleDown = true;
+    static constexpr bool doubleAfterSplit = true;
+    static constexpr bool lateSurrender = false;
+    static constexpr int  blackjackPayNum = 3;
+    static constexpr int  blackjackPayDen = 2;
+};
+
+struct SixToFiveRules {
+    static constexpr const char* name = "Carnival (6 decks, H17, no DAS, 6:5)";
+    static constexpr int  decks = 6;
+    static constexpr bool hitSoft17 = true;
+    static constexpr bool doubleDown = true;
+    static constexpr bool doubleAfterSplit = false;
+    static constexpr bool lateSurrender = false;
+    static constexpr int  blackjackPayNum = 6;
+    static constexpr int  blackjackPayDen = 5;
+};
+
+//================== Blackjack Kernel ==================//
+//------Rule checks shared by the interactive game and the simulator-------//
+// Hands are described by their hard total (aces as 1) and ace count.
+// Bools are combined with & and | on purpose so nothing short-circuits.
+template <typename Rules>
+struct BlackjackKernel {
+    static_assert(Rules::decks >= 1 && Rules::decks <= 8, "Blackjack shoes hold 1-8 decks");
+    static_assert(Rules::blackjackPayDen > 0, "Blackjack payout denominator must be positive");
+
+    static constexpr int shoeCards = Rules::decks * 52;
+    static constexpr int cutCard = shoeCards * 3 / 4; // reshuffle at 75% penetration
+
+    // Multipliers are stake + winnings, as CasinoManager::processWin expects
+    static constexpr double winMultiplier = 2.0;
+    static constexpr double pushMultiplier = 1.0;
+    static constexpr double blackjackMultiplier = 1.0 + static_cast<double>(Rules::blackjackPayNum) / Rules::blackjackPayDen;
+    static constexpr double surrenderRefund = 0.5;
+
+    static constexpr bool isSoft(int hard, int aces) { return (aces > 0) & (hard <= 11); }
+    static constexpr int bestTotal(int hard, int aces) { return hard + 10 * isSoft(hard, aces); }
+
+    static constexpr bool dealerHits(int total, bool soft) {
+        return (total < 17) | (Rules::hitSoft17 & soft & (total == 17));
+    }
+    static constexpr bool canDouble(size_t cardCount, bool afterSplit) {
+        return Rules::doubleDown & (cardCount == 2) & (!afterSplit | Rules::doubleAfterSplit);
+    }
+    static constexpr bool canSurrender(size_t cardCount, bool afterSplit) {
+        return Rules::lateSurrender & (cardCount == 2) & !afterSplit;
+    }
+};
+
+//================== Blackjack Simulator ==================//
+//------Plays basic strategy against a flat shoe of card values-------//
+struct BlackjackSimResult {
+    uint64_t rounds = 0;
+    uint64_t handsWon = 0;
+    uint64_t handsLost = 0;
+    uint64_t pushes = 0;
+    uint64_t blackjacks = 0;
+    uint64_t doubles = 0;
+    uint64_t splits = 0;
+    uint64_t surrenders = 0;
+    double wagered = 0.0;
+    double returned = 0.0;
+
+    double rtp() const { return wagered > 0.0 ? returned / wagered : 0.0; }
+    double houseEdge() const { return 1.0 - rtp(); }
+
+    BlackjackSimResult& operator+=(const BlackjackSimResult& o) {
+        rounds += o.rounds; handsWon += o.handsWon; handsLost += o.handsLost; pushes += o.pushes;
+        blackjacks += o.blackjacks; doubles += o.doubles; splits += o.splits; surrenders += o.surrenders;
+        wagered += o.wagered; returned += o.returned;
+        return *this;
+    }
+};
+
+template <typename Rules>
+class BlackjackSimulator {
+    using Kernel = BlackjackKernel<Rules>;
+
+public:
+    explicit BlackjackSimulator(uint32_t seed = 5489u) : gen(seed) {
+        // values 1..10 (ace = 1, ten/J/Q/K = 10)
+        int n = 0;
+        for (int d = 0; d < Rules::decks * 4; ++d)
+            for (int r = 1; r <= 13; ++r) shoe[n++] = static_cast<uint8_t>(r > 10 ? 10 : r);
+        std::shuffle(shoe, shoe + Kernel::shoeCards, gen);
+    }
+
+    BlackjackSimResult run(uint64_t rounds) {
+        BlackjackSimResult res;
+        for (uint64_t i = 0; i < rounds; ++i) playRound(res);
+        return res;
+    }
+
+private:
+    enum Action { Hit, Stand, Double, Surrender };
+
+    struct SimHand {
+        int hard = 0;
+        int aces = 0;
+        int cards = 0;
+        double bet = 1.0;
+        bool done = false;
+        bool surrendered = false;
+
+        void add(int v) { hard += v; aces += (v == 1); ++cards; }
+        int total() const { return Kernel::bestTotal(hard, aces); }
+        bool soft() const { return Kernel::isSoft(hard, aces); }
+    };
+
+    std::mt19937 gen;
+    uint8_t shoe[Kernel::shoeCards];
+    int pos = 0;
+    int roundStart = 0; // first card of the round being played
+
+    // A round that starts just before the cut card can run past the end of a
+    // small shoe (a split and a long dealer draw). The discards, every card
+    // before this round, are then shuffled and dealt on; the round's own cards
+    // move to the front in order, so shoe[pos - k] still finds them.
+    int draw() {
+        if (pos == Kernel::shoeCards) {
+            std::rotate(shoe, shoe + roundStart, shoe + Kernel::shoeCards);
+            pos = Kernel::shoeCards - roundStart;
+            std::shuffle(shoe + pos, shoe + Kernel::shoeCards, gen);
+            roundStart = 0;
+        }
+        return shoe[pos++];
+    }
+
+    // Simplified basic strategy; the rule-dependent parts fold per instantiation
+    Action decide(const SimHand& h, int up, bool afterSplit) const {
+        const int t = h.total();
+        const bool dbl = Kernel::canDouble(static_cast<size_t>(h.cards), afterSplit);
+        if (Kernel::canSurrender(static_cast<size_t>(h.cards), afterSplit) && !h.soft()) {
+            if ((t == 16 && up >= 9) || (t == 15 && up == 10)) return Surrender;
+        }
+        if (h.soft()) {
+            if (t >= 19) return Stand;
+            if (t == 18) {
+                if (dbl && up >= 3 && up <= 6) return Double;
+                return (up >= 9) ? Hit : Stand;
+            }
+            if (dbl && ((t == 17 && up >= 3 && up <= 6) || (t >= 15 && up >= 4 && up <= 6) || (up >= 5 && up <= 6)))
+                return Double;
+            return Hit;
+        }
+        if (t >= 17) return Stand;
+        if (t >= 13) return (up <= 6) ? Stand : Hit;
+        if (t == 12) return (up >= 4 && up <= 6) ? Stand : Hit;
+        if (t == 11) return (dbl && up != 11) ? Double : Hit;
+        if (t == 10) return (dbl && up <= 9) ? Double : Hit;
+        if (t == 9) return (dbl && up >= 3 && up <= 6) ? Double : Hit;
+        return Hit;
+    }
+
+    void playHand(SimHand& h, int up, bool afterSplit, BlackjackSimResult& res) {
+        while (!h.done) {
+            switch (decide(h, up, afterSplit)) {
+            case Surrender: h.surrendered = true; h.done = true; ++res.surrenders; break;
+            case Double:    h.bet *= 2.0; h.add(draw()); h.done = true; ++res.doubles; break;
+            case Hit:       h.add(draw()); h.done = h.total() >= 21; break;
+            case Stand:     h.done = true; break;
+            }
+        }
+    }
+
+    void settle(const SimHand& h, int dealerTotal, BlackjackSimResult& res) {
+        res.wagered += h.bet;
+        const int pt = h.total();
+        if (h.surrendered) { res.returned += h.bet * Kernel::surrenderRefund; ++res.handsLost; }
+        else if (pt > 21) ++res.handsLost;
+        else if (dealerTotal > 21 || pt > dealerTotal) { res.returned += h.bet * Kernel::winMultiplier; ++res.handsWon; }
+        else if (pt == dealerTotal) { res.returned += h.bet * Kernel::pushMultiplier; ++res.pushes; }
+        else ++res.handsLost;
+    }
+
+    void playRound(BlackjackSimResult& res) {
+        if (pos >= Kernel::cutCard) {
+            std::shuffle(shoe, shoe + Kernel::shoeCards, gen);
+            pos = 0;
+        }
+        roundStart = pos;
+        ++res.rounds;
+
+        SimHand hands[2];
+        SimHand dealer;
+        hands[0].add(draw()); dealer.add(draw());
+        hands[0].add(draw()); dealer.add(draw());
+        const int upCard = shoe[pos - 3];
+        const int up = (upCard == 1) ? 11 : upCard;
+
+        // Naturals settle immediately (dealer peeks)
+        const bool playerBJ = hands[0].total() == 21;
+        const bool dealerBJ = dealer.total() == 21;
+        if (playerBJ | dealerBJ) {
+            res.wagered += 1.0;
+            if (playerBJ & dealerBJ) { res.returned += Kernel::pushMultiplier; ++res.pushes; }
+            else if (playerBJ) { res.returned += Kernel::blackjackMultiplier; ++res.blackjacks; ++res.handsWon; }
+            else ++res.handsLost;
+            return;
+        }
+
+        // Split aces and eights once; split aces receive one card each
+        int handCount = 1;
+        const int first = shoe[pos - 4];
+        const int second = shoe[pos - 2];
+        if (first == second && (first == 1 || first == 8)) {
+            ++res.splits;
+            hands[0] = SimHand(); hands[1] = SimHand();
+            hands[0].add(first); hands[0].add(draw());
+            hands[1].add(first); hands[1].add(draw());
+            handCount = 2;
+            if (first == 1) hands[0].done = hands[1].done = true;
+        }
+
+        bool anyLive = false;
+        for (int i = 0; i < handCount; ++i) {
+            playHand(hands[i], up, handCount == 2, res);
+            anyLive |= !hands[i].surrendered & (hands[i].total() <= 21);
+        }
+
+        if (anyLive) {
+            while (Kernel::dealerHits(dealer.total(), dealer.soft())) dealer.add(draw());
+        }
+        for (int i = 0; i < handCount; ++i) settle(hands[i], dealer.total(), res);
+    }
+};
+
+// Shoes are independent: each chunk of rounds plays its own freshly shuffled
+// shoe on the job scheduler, seeded from its index
+template <typename Rules>
+BlackjackSimResult simulateBlackjack(uint64_t rounds, uint32_t seed = 5489u, JobScheduler& jobs = jobScheduler()) {
+    return jobs.parallelReduce(rounds, 1u << 16, BlackjackSimResult(),
+        [seed](const JobScheduler::Slice& s) {
+            BlackjackSimulator<Rules> sim(s.seed(seed));
+            return sim.run(s.size());
+        },
+        [](BlackjackSimResult& total, const BlackjackSimResult& part) { total += part; });
+}
@@ -1,156 +1,250 @@
 ﻿#include <iostream>
-#include <Windows.h>
-#include <limits>
-#include <thread>
 #include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <thread>
+#ifdef _WIN32
+#include <Windows.h>
+#endif
 #include "Main.h"
-#include "Blackjack.h"
-#include "Poker.h"
-#include "Baccarat.h"
-#include "HighLow.h"
-#include "Slots.h"
+#include "Games.h"
+#include "GameRegistry.h"
+#include "SaveGame.h"
+#include "Server.h"
 #include "SplashScreen.h"
+#include "Simulator.h"
 
-Player initializePlayer() {
-    std::string playerName;
+// Asks for a name until one is free; on a server another connection may be playing it
+Task<Player> initializePlayer(InputSource& input, ProfileClaim& claim) {
     drawAsciiBox("=== Welcome to the Casino! ===");
-    std::cout << "Enter your player name: ";
-    std::getline(std::cin, playerName);
-    if (playerName.empty()) playerName = "Player";
-    drawAsciiBox("Welcome, " + playerName + "! Starting with £500.");
-    return Player(playerName, 500.0);
+    std::string playerName;
+    for (;;) {
+        playerName = co_await input.readLineTrimmed("Enter your player name: ");
+        if (playerName.empty()) playerName = "Player";
+        if (claim.take(playerName)) break;
+        drawAsciiBox(playerName + " is already at the tables on another connection.\nPick another name.");
+    }
+    co_return Player(playerName, 500.0);
+}
+// Picks up where the player's saved profile left off, if there is one
+void resumeProfile(const ProfileStore& profiles, CasinoManager& casino) {
+    const std::string& name = casino.player.getName();
+    ProfileSnapshot saved;
+    std::string error;
+    if (profiles.load(name, saved, error)) {
+        saved.applyTo(casino);
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(2) << "Welcome back, " << name << u8"! Your balance is £" << casino.player.getBalance() << ".";
+        drawAsciiBox(oss.str());
+        return;
+    }
+    if (!error.empty()) drawAsciiBox(error);
+    drawAsciiBox("Welcome, " + name + u8"! Starting with £500.");
 }
-template <typename Game>
-void playGameLoop(Game& game, Player& player, const std::string& gameName, CasinoManager& casino) {
-    char replay;
-    playSplashScreen(gameName);
+// Plays rounds of one table until the player leaves; the table keeps its state afterwards
+Task<void> playGameLoop(AnyGame& game, Player& player, const GameInfo& info, CasinoManager& casino, ProfileSaver& saver) {
+    const std::string gameName(info.name);
+    bool replay;
+    co_await playSplashScreen(gameName);
     do {
-        system("cls");
+        TraceSpan round("round", gameName);
+        terminal().clear();
         drawAsciiBox("=== " + gameName + " ===");
         player.showStatus();
 
         try {
-            game.play(player, casino);
+            beginEventRound(static_cast<uint8_t>(info.order));
+            co_await game.play(player, casino);
         }
         catch (const std::exception& e) {
             drawAsciiBox(std::string("[!] Game crashed: ") + e.what());
         }
+        endEventRound();
 
-        // Loop until user enters valid y/n input
-        while (true) {
-            std::cout << "\nDo you want to play another round of " << gameName << "? (y/n): ";
-            std::cin >> replay;
-            std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        // Saved after every round, off this thread
+        saver.submit(ProfileSnapshot::of(casino));
+        std::string saveError;
+        if (saver.takeError(saveError)) drawAsciiBox(saveError);
 
-            if (replay == 'y' || replay == 'Y' || replay == 'n' || replay == 'N') break;
-            drawAsciiBox("Invalid input. Please enter 'y' or 'n'.");
-        }
+        // One keypress: y or n, anything else is ignored
+        replay = co_await casino.input.readYesNo("\nDo you want to play another round of " + gameName + "? (y/n): ");
 
-        if (replay == 'n' || replay == 'N') {
+        if (!replay) {
             drawAsciiBox("Exiting " + gameName + "...");
             casino.showStats();
         }
 
-    } while (replay == 'y' || replay == 'Y');
+    } while (replay);
 }
-int main() {
-    SetConsoleOutputCP(CP_UTF8);
-    SetConsoleCP(CP_UTF8);
-    srand(static_cast<unsigned>(time(nullptr)));
-
-    openSplashScreen("Welcome to Dammy's Casino");
-
-    Player player = initializePlayer();
-	CasinoManager casino(player);
-
-    char playAnotherGame = 'y';
-
-    while (playAnotherGame == 'y' || playAnotherGame == 'Y') {
-        system("cls");
+// One whole visit: a name, its saved profile, and the menu until the player
+// leaves. The console makes one; a server makes one per connection, with
+// `claims` keeping each name to a single connection. Either way it is one
+// coroutine, suspended whenever it waits for the player.
+Task<void> visitCasino(InputSource& input, const ProfileStore& profiles, ProfileSaver& saver, ProfileClaims* claims = nullptr) {
+    co_await openSplashScreen("Welcome to Dammy's Casino");
+
+    ProfileClaim claim(claims);
+    Player player = co_await initializePlayer(input, claim);
+	CasinoManager casino(player, input);
+    resumeProfile(profiles, casino);
+
+    GameRoom room;
+    const int games = static_cast<int>(room.size());
+    const int statusChoice = games + 1, metricsChoice = games + 2, exitChoice = games + 3;
+    bool playAnotherGame = true;
+
+    while (playAnotherGame) {
+        terminal().clear();
         drawAsciiBox("=== CASINO MAIN MENU ===");
-        std::cout << u8"Your balance: £" << player.getBalance() << "\n";
-        std::cout << "Choose a game to play:\n";
-        std::cout << "1. Blackjack\n";
-        std::cout << "2. Poker (Texas Hold'em)\n";
-        std::cout << "3. Baccarat\n";
-        std::cout << "4. High-Low\n";
-        std::cout << "5. Slots\n";
-        std::cout << "6. View Status / Mana / Curses\n";
-        std::cout << "7. Exit Casino\n";
-
-        int choice;
-        while (true) {
-            std::cout << "\nEnter the number of your choice: ";
-            std::cin >> choice;
-
-            if (std::cin.fail() || choice < 1 || choice > 7) {
-                std::cin.clear();
-                std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-                drawAsciiBox("Invalid input. Please enter a number 1–7.");
-            }
-            else break;
+        FrameBuffer& out = frame();
+        out << u8"Your balance: £" << player.getBalance() << "\n";
+        out << "Choose a game to play:\n";
+        for (int i = 0; i < games; ++i) {
+            const GameInfo& game = room.info(i);
+            out << i + 1 << ". " << game.label << ((game.capabilities & AutoPlay) ? "  [auto-play]" : "") << "\n";
         }
+        out << statusChoice << ". View Status / Mana / Curses\n";
+        out << metricsChoice << ". View Metrics\n";
+        out << exitChoice << ". Exit Casino\n";
+        out.present();
 
-        system("cls");
+        // A single keypress picks a game while the menu fits in one digit
+        const char* prompt = "\nEnter the number of your choice: ";
+        const int choice = exitChoice <= 9 ? co_await casino.input.readChoice(prompt, 1, exitChoice) : co_await casino.input.readInt(prompt, 1, exitChoice);
 
-        switch (choice) {
-        case 1: {
-            Blackjack blackjackGame;
-            playGameLoop(blackjackGame, player, "Blackjack", casino);
-            break;
-        }
-        case 2: {
-            Poker pokerGame;
-            playGameLoop(pokerGame, player, "Poker", casino);
-            break;
-        }
-        case 3: {
-            Baccarat baccaratGame;
-            playGameLoop(baccaratGame, player, "Baccarat", casino);
-            break;
-        }
-        case 4: {
-            HighLow highLowGame;
-            playGameLoop(highLowGame, player, "High-Low", casino);
-            break;
-        }
-        case 5: {
-            Slots slotsGame;
-            playGameLoop(slotsGame, player, "Slots", casino);
-            break;
+        terminal().clear();
+
+        if (choice <= games) {
+            co_await playGameLoop(room.table(choice - 1), player, room.info(choice - 1), casino, saver);
         }
-        case 6: {
-            system("cls");
+        else if (choice == statusChoice) {
             player.showStatus();
-            std::cout << "\nPress Enter to return to menu...";
-            std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-            std::cin.get();
-            break;
+            co_await casino.input.pauseEnter("\nPress any key to return to menu...");
         }
-        case 7: {
-            drawAsciiBox("=== Exiting Casino ===");
-            playAnotherGame = 'n';
-            break;
+        else if (choice == metricsChoice) {
+            drawAsciiBox(readMetrics().describe());
+            co_await casino.input.pauseEnter("\nPress any key to return to menu...");
         }
+        else {
+            drawAsciiBox("=== Exiting Casino ===");
+            playAnotherGame = false;
         }
 
         // Ask to continue only if not exiting
-        if (playAnotherGame != 'n') {
-            while (true) {
-                std::cout << "\nDo you want to play another game? (y/n): ";
-                std::cin >> playAnotherGame;
-
-                if (playAnotherGame == 'y' || playAnotherGame == 'Y' ||
-                    playAnotherGame == 'n' || playAnotherGame == 'N') break;
+        if (playAnotherGame) playAnotherGame = co_await casino.input.readYesNo("\nDo you want to play another game? (y/n): ");
+    }
 
-                drawAsciiBox("Invalid input. Please enter 'y' or 'n'.");
-                std::cin.clear();
+    saver.submit(ProfileSnapshot::of(casino));
+    co_await exitSplashScreen("=== Exiting Casino ===\n");
+    drawAsciiBox("Thank you for visiting the Casino, " + player.getName() + "! Goodbye!");
+	casino.showStats();
+}
+int main(int argc, char* argv[]) {
+#ifdef _WIN32
+    SetConsoleOutputCP(CP_UTF8);
+    SetConsoleCP(CP_UTF8);
+#endif
+
+    if (runSimulatorFromArgs(argc, argv)) return 0;
+
+    // --speed <factor> scales every animation; 0 shows final frames only.
+    // --script <file> answers every prompt from a file instead of the keyboard.
+    // --events <file> appends the round log somewhere other than events.log; "off" disables it.
+    // --saves <dir> keeps player profiles somewhere other than saves/; "off" disables them.
+    // --serve <socket> hosts sessions over a Unix domain socket on --threads <n> workers;
+    // --connect <socket> plays on such a server.
+    // --trace <file> writes a Chrome trace of rounds, games and frames (Trace.h).
+    InputSource* input = &consoleInput();
+    ScriptInput script;
+    std::string eventPath = "events.log", saveDir = "saves", servePath, connectPath, tracePath;
+    unsigned serverThreads = 0;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--speed") == 0) animator().setSpeed(std::atof(argv[i + 1]));
+        else if (std::strcmp(argv[i], "--events") == 0) eventPath = std::strcmp(argv[i + 1], "off") == 0 ? "" : argv[i + 1];
+        else if (std::strcmp(argv[i], "--saves") == 0) saveDir = std::strcmp(argv[i + 1], "off") == 0 ? "" : argv[i + 1];
+        else if (std::strcmp(argv[i], "--serve") == 0) servePath = argv[i + 1];
+        else if (std::strcmp(argv[i], "--threads") == 0) serverThreads = static_cast<unsigned>(std::strtoul(argv[i + 1], nullptr, 10));
+        else if (std::strcmp(argv[i], "--connect") == 0) connectPath = argv[i + 1];
+        else if (std::strcmp(argv[i], "--trace") == 0) tracePath = argv[i + 1];
+        else if (std::strcmp(argv[i], "--script") == 0) {
+            std::string error;
+            if (!script.open(argv[i + 1], error)) {
+                drawAsciiBox(error);
+                return 1;
             }
+            input = &script;
         }
     }
 
-    exitSplashScreen("=== Exiting Casino ===\n");
-    drawAsciiBox("Thank you for visiting the Casino, " + player.getName() + "! Goodbye!");
-	casino.showStats();
+    std::string traceError;
+    if (!tracePath.empty() && !traceLog().open(tracePath, traceError)) drawAsciiBox(traceError + "\nRunning without a trace.");
+
+    if (!servePath.empty() || !connectPath.empty()) {
+#ifdef _WIN32
+        drawAsciiBox("The casino server and client need a POSIX system.");
+        return 1;
+#else
+        if (!connectPath.empty()) return runCasinoClient(connectPath);
+        // Sessions do not write the round log; every visit is saved to its profile
+        const ProfileStore profiles(saveDir);
+        ProfileSaver saver(profiles);
+        ProfileClaims claims;
+        CasinoServer server(servePath, serverThreads, [&](InputSource& in) { return visitCasino(in, profiles, saver, &claims); });
+        std::string error;
+        if (!server.listen(error)) {
+            drawAsciiBox(error);
+            return 1;
+        }
+        drawAsciiBox("Casino server on " + servePath + " with " + std::to_string(server.threads()) + " worker threads.\nCtrl-C to stop.");
+        server.run();
+        return 0;
+#endif
+    }
+
+    static EventLog events;
+    std::string eventError;
+    if (!eventPath.empty() && !events.open(eventPath, eventError)) drawAsciiBox(eventError + "\nPlaying without a round log.");
+    if (events.isOpen()) {
+        // The keyboard installs its signal handlers when first used; set it up
+        // first so the log's handler runs before it and then chains to it
+        if (input == &consoleInput()) (void)keyboard();
+        events.flushOnSignals();
+    }
+    EventScope recording(events);
+
+    // Static, like the event log, so a save still pending is written if input closes and exit() runs
+    static const ProfileStore profiles(saveDir);
+    static ProfileSaver saver(profiles);
+    runTask(visitCasino(*input, profiles, saver));
     return 0;
 }
+
+//------Allocation counting-------//
+// Every form of the global operator new counts into the thread's metrics
+// shard (Metrics.h) and takes its memory from malloc; every form of delete
+// gives it back to free. The aligned forms keep the library's own pair.
+// The deletes stay out of line: inlined, GCC sees free() called on the
+// result of a new-expression and reports a mismatch that is not there.
+#ifdef _MSC_VER
+#define CASINO_OUT_OF_LINE __declspec(noinline)
+#else
+#define CASINO_OUT_OF_LINE __attribute__((noinline))
+#endif
+void* operator new(std::size_t size) {
+    countAllocation();
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return ::operator new(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    countAllocation();
+    return std::malloc(size ? size : 1);
+}
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept { return ::operator new(size, tag); }
+CASINO_OUT_OF_LINE void operator delete(void* p) noexcept { std::free(p); }
+CASINO_OUT_OF_LINE void operator delete[](void* p) noexcept { std::free(p); }
+CASINO_OUT_OF_LINE void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+CASINO_OUT_OF_LINE void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+CASINO_OUT_OF_LINE void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+CASINO_OUT_OF_LINE void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
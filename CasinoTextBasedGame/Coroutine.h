@@ -0,0 +1,260 @@
+﻿#pragma once
+#include <algorithm>
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#ifndef _WIN32
+#include <poll.h>
+#endif
+
+class Terminal;
+
+//================== Coroutines ==================//
+//------What the running session sees-------//
+// Output capture, terminal and random generator of the code running on this
+// thread. The console leaves all three null (stdout, the console terminal,
+// the process generator). A server session points them at its own while it
+// runs, and the event loop puts them back each time it resumes a coroutine.
+// `track` keeps a session's trace spans (Trace.h) on a timeline of their own.
+struct SessionContext {
+    std::string* output = nullptr;
+    Terminal* terminal = nullptr;
+    std::mt19937* rng = nullptr;
+    int track = 0; // the session's socket; 0 traces on the thread's timeline
+};
+
+inline SessionContext& sessionContext() {
+    thread_local SessionContext context;
+    return context;
+}
+
+//------Tasks-------//
+// Every game flow, prompt and animation is a Task: a coroutine that starts
+// when it is awaited and, when it finishes, hands control straight back to
+// whoever awaited it. A flow that never has to wait (a script, a bot, a
+// NullView table) therefore runs like a chain of plain calls. Exceptions
+// travel up through co_await.
+//
+// A co_await is never the condition of an if, while or switch: GCC 12
+// miscompiles the whole coroutine when it is. Await into a local first.
+template <typename T = void>
+class Task;
+
+struct TaskPromiseBase {
+    std::coroutine_handle<> continuation;
+    std::exception_ptr error;
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept {
+            const std::coroutine_handle<> next = h.promise().continuation;
+            return next ? next : std::noop_coroutine();
+        }
+        void await_resume() noexcept {}
+    };
+    FinalAwaiter final_suspend() noexcept { return {}; }
+
+    void unhandled_exception() { error = std::current_exception(); }
+};
+
+template <typename T>
+struct TaskPromise : TaskPromiseBase {
+    std::optional<T> value;
+
+    Task<T> get_return_object();
+    template <typename U>
+    void return_value(U&& v) { value.emplace(std::forward<U>(v)); }
+};
+
+template <>
+struct TaskPromise<void> : TaskPromiseBase {
+    Task<void> get_return_object();
+    void return_void() {}
+};
+
+template <typename T>
+class [[nodiscard]] Task {
+public:
+    using promise_type = TaskPromise<T>;
+
+    Task() = default;
+    explicit Task(std::coroutine_handle<promise_type> h) : h(h) {}
+    Task(Task&& other) noexcept : h(std::exchange(other.h, {})) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (h) h.destroy();
+            h = std::exchange(other.h, {});
+        }
+        return *this;
+    }
+    ~Task() {
+        if (h) h.destroy();
+    }
+
+    bool done() const { return !h || h.done(); }
+
+    auto operator co_await() && noexcept {
+        struct Awaiter {
+            std::coroutine_handle<promise_type> h;
+            bool await_ready() const noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept {
+                h.promise().continuation = caller;
+                return h;
+            }
+            T await_resume() { return Task::take(h); }
+        };
+        return Awaiter{ h };
+    }
+
+    // For a top-level task: runs it until it first waits, or to the end
+    void start() {
+        if (h && !h.done()) h.resume();
+    }
+
+    // A finished top-level task's value; rethrows what it threw
+    T result() { return take(h); }
+
+private:
+    std::coroutine_handle<promise_type> h{};
+
+    static T take(std::coroutine_handle<promise_type> h) {
+        if (h.promise().error) std::rethrow_exception(h.promise().error);
+        if constexpr (!std::is_void_v<T>) return std::move(*h.promise().value);
+    }
+};
+
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object() { return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this)); }
+inline Task<void> TaskPromise<void>::get_return_object() { return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this)); }
+
+//------Event loop-------//
+// One per thread. A coroutine that has to wait for a file descriptor, a
+// deadline or both parks here, and runOnce() sleeps in a single poll() until
+// the first of them is due, then resumes whoever it was for. The console is
+// one loop waiting on stdin; each server worker is one loop waiting on its
+// players' sockets. On Windows only deadlines can be waited for (the
+// keyboard polls the console itself there).
+class EventLoop {
+public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr Clock::time_point never = Clock::time_point::max();
+
+    struct Ready {
+        EventLoop& loop;
+        int fd;
+        short events;
+        Clock::time_point deadline;
+        short revents = 0;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) { loop.waiters.push_back({ fd, events, deadline, h, &revents, sessionContext() }); }
+        short await_resume() const noexcept { return revents; }
+    };
+
+    // co_await: the poll() events that arrived on fd, or 0 at the deadline
+    Ready ready(int fd, short events, Clock::time_point deadline = never) { return Ready{ *this, fd, events, deadline }; }
+
+    // co_await: resumes at the deadline
+    Ready sleepUntil(Clock::time_point deadline) { return Ready{ *this, -1, 0, deadline }; }
+
+    // co_await: lets everything else that is due run first
+    Ready yield() { return Ready{ *this, -1, 0, Clock::time_point::min() }; }
+
+    // Resumes whatever waits on fd on the next turn, with no events
+    void wake(int fd) {
+        for (Waiter& w : waiters) {
+            if (w.fd == fd) w.deadline = Clock::time_point::min();
+        }
+    }
+
+    bool idle() const { return waiters.empty(); }
+    size_t waiting() const { return waiters.size(); }
+
+    // Sleeps until something is due, then resumes it
+    void runOnce() {
+        if (waiters.empty()) return;
+        Clock::time_point next = never;
+        for (const Waiter& w : waiters) next = std::min(next, w.deadline);
+#ifdef _WIN32
+        if (next != never && next > Clock::now()) std::this_thread::sleep_until(next);
+#else
+        fds.clear();
+        for (const Waiter& w : waiters) fds.push_back({ w.fd, w.events, 0 }); // fd -1 is ignored by poll
+        int timeout = -1;
+        if (next != never) {
+            const Clock::time_point now = Clock::now();
+            const auto left = next <= now ? 0 : std::chrono::duration_cast<std::chrono::milliseconds>(next - now + std::chrono::microseconds(999)).count();
+            timeout = static_cast<int>(std::min<long long>(left, 1 << 30));
+        }
+        if (poll(fds.data(), static_cast<nfds_t>(fds.size()), timeout) < 0) return; // EINTR: next turn
+#endif
+        const Clock::time_point now = Clock::now();
+        std::vector<Waiter> due;
+        due.swap(resumed);
+        size_t kept = 0;
+        for (size_t i = 0; i < waiters.size(); ++i) {
+#ifdef _WIN32
+            const short revents = 0;
+#else
+            const short revents = fds[i].revents;
+#endif
+            if (revents || waiters[i].deadline <= now) {
+                *waiters[i].revents = revents;
+                due.push_back(waiters[i]);
+            }
+            else waiters[kept++] = waiters[i];
+        }
+        waiters.resize(kept);
+
+        // Anything resumed may park again; it lands in `waiters` for the next turn
+        const SessionContext outer = sessionContext();
+        for (const Waiter& w : due) {
+            sessionContext() = w.context;
+            w.h.resume();
+        }
+        sessionContext() = outer;
+        due.clear();
+        resumed.swap(due); // keeps the capacity for the next turn
+    }
+
+private:
+    struct Waiter {
+        int fd;
+        short events;
+        Clock::time_point deadline;
+        std::coroutine_handle<> h;
+        short* revents;
+        SessionContext context;
+    };
+    std::vector<Waiter> waiters;
+    std::vector<Waiter> resumed; // spare buffer for runOnce
+#ifndef _WIN32
+    std::vector<pollfd> fds;
+#endif
+};
+
+inline EventLoop& eventLoop() {
+    thread_local EventLoop loop;
+    return loop;
+}
+
+// Runs a task to the end on this thread's loop and returns its value. A task
+// still suspended once the loop has nothing left to wake it waits on
+// something the loop does not know about, and would never finish.
+template <typename T>
+T runTask(Task<T> task) {
+    task.start();
+    while (!task.done() && !eventLoop().idle()) eventLoop().runOnce();
+    if (!task.done()) throw std::logic_error("runTask: task is suspended on nothing the event loop can resume");
+    return task.result();
+}
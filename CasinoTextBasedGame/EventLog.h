@@ -0,0 +1,332 @@
+﻿#pragma once
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <utility>
+#ifdef _WIN32
+#include <Windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//================== Round Event Log ==================//
+//------Records-------//
+// Every record is 16 bytes, so the file is an array: record i is at byte
+// 16 * (i + 1), after a 16-byte header. Amounts are whole micro-pounds.
+// Fields are written in the machine's byte order (little-endian on every
+// platform this builds for).
+enum class EventType : uint8_t {
+    SessionStart, // amount = Unix time in seconds
+    RoundStart,   // game = menu position of the game
+    BetPlaced,    // amount = stake taken from the balance
+    CardDealt,    // detail = card, suit * 13 + (rank - 2)
+    BlessingCast, // detail = EventBlessing
+    CurseApplied, // detail = EventCurse, aux = 0 new, 1 refreshed, 2 absorbed by Mana Shield
+    Payout,       // amount = everything paid back, stake included
+    Loss,         // amount = stake lost
+    Refund,       // amount = stake returned on a push
+};
+constexpr int eventTypeCount = 9;
+
+enum EventBlessing : uint8_t { FatesGlimpse = 1, LuckyDraw = 2, ManaShield = 3 };
+enum EventCurse : uint8_t { OtherCurse = 0, MuddledSight = 1, UnluckyHand = 2 };
+
+struct EventRecord {
+    uint32_t round;  // rounds are numbered from 1 within a session
+    EventType type;
+    uint8_t game;
+    uint8_t detail;
+    uint8_t aux;
+    int64_t amount;
+};
+static_assert(sizeof(EventRecord) == 16, "event records are 16 bytes on disk");
+
+struct EventLogHeader {
+    char magic[8];        // "CASEVT1"
+    uint32_t recordSize;  // 16
+    uint32_t reserved;
+};
+static_assert(sizeof(EventLogHeader) == sizeof(EventRecord), "the header takes one record slot");
+
+inline int64_t toEventMicros(double pounds) {
+    return static_cast<int64_t>(pounds * 1e6 + (pounds < 0.0 ? -0.5 : 0.5));
+}
+
+//------Writer-------//
+// Appends to the file in batches: records collect in a fixed buffer and go
+// out in one write when it fills, on flush() or close, and from flushIfDue()
+// once flushInterval has passed since the last write. Recording is a store
+// and an increment, with no allocation, lock or system call. A Ctrl-C runs no
+// destructors, so flushOnSignals() writes the buffer out from the signal
+// handler; a hard crash loses at most the last flushInterval of play.
+class EventLog {
+public:
+    static constexpr size_t batchRecords = 4096; // 64 KiB per write
+    static constexpr std::chrono::milliseconds flushInterval{ 100 };
+
+    EventLog() = default;
+    ~EventLog() { close(); }
+    EventLog(const EventLog&) = delete;
+    EventLog& operator=(const EventLog&) = delete;
+
+    // Opens for appending (a new file gets the header); truncate starts afresh
+    bool open(const std::string& path, std::string& error, bool truncate = false) {
+        close();
+        file = std::fopen(path.c_str(), truncate ? "wb" : "ab");
+        if (!file) {
+            error = "Cannot open event log: " + path;
+            return false;
+        }
+        // Unbuffered: every flush is one write(), which the signal handler can repeat safely
+        std::setvbuf(file, nullptr, _IONBF, 0);
+        // A crash can leave part of a record at the end. Appending after it
+        // would shift every later record, so the tail is cut back to whole
+        // records first; a file too short for its header starts again.
+        std::fseek(file, 0, SEEK_END);
+        const long size = std::ftell(file);
+        const long record = static_cast<long>(sizeof(EventRecord));
+        const long whole = size < static_cast<long>(sizeof(EventLogHeader)) ? 0 : size - size % record;
+        if (whole != size && !truncateTo(file, whole)) {
+            std::fclose(file);
+            file = nullptr;
+            error = "Cannot repair the torn end of event log: " + path;
+            return false;
+        }
+        if (whole == 0) {
+            EventLogHeader header{ { 'C', 'A', 'S', 'E', 'V', 'T', '1', '\0' }, sizeof(EventRecord), 0 };
+            std::fwrite(&header, sizeof header, 1, file);
+        }
+        round = 0;
+        game = 0;
+        written = 0;
+#ifdef _WIN32
+        fd = _fileno(file);
+#else
+        fd = fileno(file);
+#endif
+        lastFlush = std::chrono::steady_clock::now();
+        const auto now = std::chrono::system_clock::now().time_since_epoch();
+        append(EventType::SessionStart, 0, 0, std::chrono::duration_cast<std::chrono::seconds>(now).count());
+        return true;
+    }
+
+    bool isOpen() const { return file != nullptr; }
+    // Records since open()
+    uint64_t recordsWritten() const { return written + used; }
+
+    void beginRound(uint8_t gameId) {
+        ++round;
+        game = gameId;
+        append(EventType::RoundStart, 0, 0, 0);
+    }
+
+    void append(EventType type, uint8_t detail, uint8_t aux, int64_t amount) {
+        EventRecord& r = batch[used];
+        r.round = round;
+        r.type = type;
+        r.game = game;
+        r.detail = detail;
+        r.aux = aux;
+        r.amount = amount;
+        if (++used == batchRecords) flush();
+    }
+
+    void flush() {
+        lastFlush = std::chrono::steady_clock::now();
+        if (!file) used = 0; // closed: records are dropped
+        if (used == 0) return;
+        writing = 1;
+        std::fwrite(batch, sizeof(EventRecord), used, file);
+        written += used;
+        used = 0;
+        writing = 0;
+    }
+
+    // Called between rounds: a clock read, and a write only if the interval has passed
+    void flushIfDue() {
+        if (used && std::chrono::steady_clock::now() - lastFlush >= flushInterval) flush();
+    }
+
+    // Writes this log's buffer out when SIGINT or SIGTERM arrives, then hands the
+    // signal to whatever handled it before (the keyboard restores the terminal)
+    void flushOnSignals() {
+        signalLog = this;
+        previousInt = std::signal(SIGINT, flushAndReraise);
+        previousTerm = std::signal(SIGTERM, flushAndReraise);
+    }
+
+    void close() {
+        if (signalLog == this) signalLog = nullptr;
+        if (!file) return;
+        flush();
+        std::fclose(file);
+        file = nullptr;
+        fd = -1;
+    }
+
+private:
+    using SignalHandler = void (*)(int);
+    static inline EventLog* volatile signalLog = nullptr;
+    static inline SignalHandler previousInt = SIG_DFL;
+    static inline SignalHandler previousTerm = SIG_DFL;
+
+    std::FILE* file = nullptr;
+    int fd = -1;
+    EventRecord batch[batchRecords];
+    std::chrono::steady_clock::time_point lastFlush;
+    volatile std::sig_atomic_t writing = 0;
+
+    // Only write() is safe here. A flush the signal interrupted has already
+    // been written or is about to be lost with the process, so it is skipped.
+    static void flushAndReraise(int sig) {
+        EventLog* log = signalLog;
+        if (log && log->fd >= 0 && !log->writing && log->used) {
+#ifdef _WIN32
+            (void)_write(log->fd, log->batch, static_cast<unsigned>(log->used * sizeof(EventRecord)));
+#else
+            (void)::write(log->fd, log->batch, log->used * sizeof(EventRecord));
+#endif
+            log->used = 0;
+        }
+        const SignalHandler previous = (sig == SIGINT) ? previousInt : previousTerm;
+        std::signal(sig, (previous == SIG_ERR || previous == nullptr) ? SIG_DFL : previous);
+        std::raise(sig);
+    }
+
+    static bool truncateTo(std::FILE* f, long size) {
+        std::fflush(f);
+#ifdef _WIN32
+        const bool ok = _chsize_s(_fileno(f), size) == 0;
+#else
+        const bool ok = ftruncate(fileno(f), size) == 0;
+#endif
+        std::fseek(f, 0, SEEK_END);
+        return ok;
+    }
+    size_t used = 0;
+    uint64_t written = 0;
+    uint32_t round = 0;
+    uint8_t game = 0;
+};
+
+//------Where this thread records-------//
+// Deck, Player and CasinoManager record through here, so games emit events
+// without knowing about the log. Null means nothing is recorded.
+inline EventLog*& currentEventLog() {
+    thread_local EventLog* log = nullptr;
+    return log;
+}
+
+inline void recordEvent(EventType type, uint8_t detail = 0, uint8_t aux = 0, int64_t amount = 0) {
+    if (EventLog* log = currentEventLog()) log->append(type, detail, aux, amount);
+}
+
+// Starts a round of `game` (its menu position) in this thread's log, if any
+inline void beginEventRound(uint8_t game) {
+    if (EventLog* log = currentEventLog()) log->beginRound(game);
+}
+
+// Between rounds: writes the buffer out if flushInterval has passed since the last write
+inline void endEventRound() {
+    if (EventLog* log = currentEventLog()) log->flushIfDue();
+}
+
+// Points this thread at `log` for the scope (nothing is recorded if it is closed)
+class EventScope {
+public:
+    explicit EventScope(EventLog& log) : previous(currentEventLog()) {
+        currentEventLog() = log.isOpen() ? &log : nullptr;
+    }
+    ~EventScope() { currentEventLog() = previous; }
+    EventScope(const EventScope&) = delete;
+    EventScope& operator=(const EventScope&) = delete;
+
+private:
+    EventLog* previous;
+};
+
+//------Reader-------//
+// Maps a log read-only and hands out its records as an array, so a scan is a
+// walk over memory with no reads or copies.
+class MappedEventLog {
+public:
+    MappedEventLog() = default;
+    ~MappedEventLog() { unmap(); }
+    MappedEventLog(const MappedEventLog&) = delete;
+    MappedEventLog& operator=(const MappedEventLog&) = delete;
+
+    bool open(const std::string& path, std::string& error) {
+        unmap();
+#ifdef _WIN32
+        HANDLE f = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (f == INVALID_HANDLE_VALUE) return fail(error, "Cannot open event log: " + path);
+        LARGE_INTEGER size;
+        GetFileSizeEx(f, &size);
+        bytes = static_cast<size_t>(size.QuadPart);
+        if (bytes >= sizeof(EventLogHeader)) {
+            mapping = CreateFileMappingA(f, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping) base = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        }
+        CloseHandle(f);
+#else
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return fail(error, "Cannot open event log: " + path);
+        struct stat st {};
+        fstat(fd, &st);
+        bytes = static_cast<size_t>(st.st_size);
+        if (bytes >= sizeof(EventLogHeader)) {
+            void* p = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                base = static_cast<const char*>(p);
+                madvise(p, bytes, MADV_SEQUENTIAL);
+            }
+        }
+        ::close(fd);
+#endif
+        if (!base) return fail(error, bytes < sizeof(EventLogHeader) ? "Event log is empty: " + path : "Cannot map event log: " + path);
+        EventLogHeader header;
+        std::memcpy(&header, base, sizeof header);
+        if (std::memcmp(header.magic, "CASEVT1", 8) != 0 || header.recordSize != sizeof(EventRecord)) {
+            unmap();
+            return fail(error, "Not a casino event log: " + path);
+        }
+        return true;
+    }
+
+    // A torn final record (from a crash mid-write) is left out
+    size_t size() const { return base ? (bytes - sizeof(EventLogHeader)) / sizeof(EventRecord) : 0; }
+    const EventRecord* begin() const { return reinterpret_cast<const EventRecord*>(base + sizeof(EventLogHeader)); }
+    const EventRecord* end() const { return begin() + size(); }
+    const EventRecord& operator[](size_t i) const { return begin()[i]; }
+
+private:
+    const char* base = nullptr;
+    size_t bytes = 0;
+#ifdef _WIN32
+    HANDLE mapping = nullptr;
+#endif
+
+    static bool fail(std::string& error, std::string message) {
+        error = std::move(message);
+        return false;
+    }
+
+    void unmap() {
+#ifdef _WIN32
+        if (base) UnmapViewOfFile(base);
+        if (mapping) CloseHandle(mapping);
+        mapping = nullptr;
+#else
+        if (base) munmap(const_cast<char*>(base), bytes);
+#endif
+        base = nullptr;
+        bytes = 0;
+    }
+};
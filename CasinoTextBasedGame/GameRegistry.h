@@ -0,0 +1,119 @@
+﻿#pragma once
+#include <algorithm>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include "Main.h"
+
+//================== Game Registry ==================//
+//------Any game, behind one interface-------//
+// Holds a game of any type that has Task<void> play(Player&, CasinoManager&).
+// The game lives inside, so its deck, shoe and table state last as long as
+// the holder.
+class AnyGame {
+public:
+    AnyGame() = default;
+
+    template <typename Game>
+    static AnyGame make() {
+        AnyGame g;
+        g.self = std::make_unique<Model<Game>>();
+        return g;
+    }
+
+    explicit operator bool() const { return static_cast<bool>(self); }
+    Task<void> play(Player& player, CasinoManager& casino) { return self->play(player, casino); }
+
+private:
+    struct Concept {
+        virtual ~Concept() = default;
+        virtual Task<void> play(Player& player, CasinoManager& casino) = 0;
+    };
+    template <typename Game>
+    struct Model : Concept {
+        Game game;
+        Task<void> play(Player& player, CasinoManager& casino) override { return game.play(player, casino); }
+    };
+
+    std::unique_ptr<Concept> self;
+};
+
+//------What a game offers-------//
+enum GameCapability : unsigned {
+    KeepsShoe = 1u << 0, // cards or table state carry over from round to round
+    Blessings = 1u << 1, // offers a blessing before the round
+    AutoPlay = 1u << 2,  // can settle many rounds in one go
+};
+
+struct GameInfo {
+    std::string_view name;  // titles and splash screens
+    std::string_view label; // the main menu line
+    int order;              // position in the menu
+    unsigned capabilities;
+};
+
+//------The catalogue-------//
+// Every game header registers its game once, at static initialisation, with
+// a factory for the console build and one for the NullView build. The menu
+// and the soak test list whatever is registered, so a new game only needs its
+// header included from Games.h.
+class GameRegistry {
+public:
+    struct Entry {
+        GameInfo info;
+        AnyGame (*make)();         // ConsoleView build
+        AnyGame (*makeHeadless)(); // NullView build, for bots and soak runs
+    };
+
+    static GameRegistry& instance() {
+        static GameRegistry registry;
+        return registry;
+    }
+
+    template <typename Game, typename HeadlessGame>
+    bool add(const GameInfo& info) {
+        const Entry entry{ info, &AnyGame::make<Game>, &AnyGame::make<HeadlessGame> };
+        const auto at = std::upper_bound(entries.begin(), entries.end(), entry,
+            [](const Entry& a, const Entry& b) { return a.info.order < b.info.order; });
+        entries.insert(at, entry);
+        return true;
+    }
+
+    const std::vector<Entry>& games() const { return entries; }
+    size_t size() const { return entries.size(); }
+
+private:
+    std::vector<Entry> entries;
+};
+
+// For game headers: inline const bool registered = registerGame<Game, HeadlessGame>({ ... });
+template <typename Game, typename HeadlessGame>
+bool registerGame(const GameInfo& info) {
+    return GameRegistry::instance().add<Game, HeadlessGame>(info);
+}
+
+//------A session's tables-------//
+// One instance per registered game, built the first time it is chosen and
+// kept for the session, so leaving a game and coming back finds the same
+// shoe, deck position and dealer button.
+class GameRoom {
+public:
+    explicit GameRoom(bool headless = false, const GameRegistry& registry = GameRegistry::instance())
+        : registry(registry), headless(headless), tables(registry.size()) {}
+
+    size_t size() const { return tables.size(); }
+    const GameInfo& info(size_t i) const { return registry.games()[i].info; }
+
+    AnyGame& table(size_t i) {
+        if (!tables[i]) {
+            const GameRegistry::Entry& e = registry.games()[i];
+            tables[i] = headless ? e.makeHeadless() : e.make();
+        }
+        return tables[i];
+    }
+
+private:
+    const GameRegistry& registry;
+    const bool headless;
+    std::vector<AnyGame> tables;
+};
@@ -0,0 +1,10 @@
+﻿#pragma once
+// Every game at the casino. Each header registers its game with the
+// GameRegistry, so including it here is all it takes to put a game on the
+// main menu and in the soak test.
+#include "Blackjack.h"
+#include "Poker.h"
+#include "Baccarat.h"
+#include "HighLow.h"
+#include "Slots.h"
+#include "VideoSlots.h"
@@ -1,80 +1,232 @@
 ﻿#pragma once
 #include "Main.h"
+#include "HighLowOdds.h"
+#include "GameRegistry.h"
+#include "View.h"
+#include <iomanip>
 
+//================== Game Definition ==================//
 // High/Low - draw one card, player guesses higher or lower
-class HighLow {
+// View is ConsoleView or NullView (View.h); see the HighLow alias below
+template <typename View = ConsoleView>
+class BasicHighLow {
 private:
+	View view;
+	enum Mode { Classic = 1, ClassicSameDeck = 2, Ladder = 3 };
+
 	Deck deck;
+	RankHistogram remaining;
+	HighLowLadderSolver solver;
+	Mode mode = Classic;
+	bool persistentDeck = false;
+	bool modeChosen = false;
+
+	// Every card leaving the deck goes through here so the histogram stays exact
+	Card dealTracked() {
+		Card c = deck.dealCard();
+		remaining.remove(c.getRank());
+		return c;
+	}
+
+	// The ladder solver's states for the old deck can never come up again
+	void reshuffle() {
+		deck.refill();
+		deck.shuffle();
+		remaining.reset(deck);
+		solver.clear();
+		if (mode == Ladder) solver.warm(remaining);
+	}
+
+	static void drawOdds(FrameBuffer& out, const RankHistogram& remaining, const Card& shown) {
+		RankHistogram::Odds o = remaining.against(shown.getRank());
+		std::ostringstream oss;
+		oss << std::fixed << std::setprecision(1);
+		oss << remaining.total << " cards left | Higher " << o.higher * 100 << "% | Lower " << o.lower * 100
+			<< "% | Tie " << o.tie * 100 << "%";
+		drawAsciiBox(out, oss.str());
+	}
+
+	// The card under a heading, plus the odds for the next draw when given
+	void showCard(const char* heading, const Card& c, bool withOdds) const {
+		view.draw([&](FrameBuffer& out) {
+			out << heading;
+			for (int line = 0; line < Card::artRows; ++line) out << c.artRow(line) << '\n';
+			if (withOdds) drawOdds(out, remaining, c);
+		});
+	}
+
+	// The solver is only consulted when the hint is actually shown
+	void showLadder(int rung, double bet, const Card& current) {
+		view.draw([&](FrameBuffer& out) {
+			HighLowLadderSolver::Advice hint;
+			const bool solved = solver.advise(remaining, current.getRank(), rung, hint);
+			const auto& ladder = solver.paytable();
+			std::ostringstream oss;
+			oss << std::fixed << std::setprecision(2);
+			oss << "LADDER  rung " << rung << "/" << HighLowLadderSolver::rungs << "\n";
+			for (int r = 1; r <= HighLowLadderSolver::rungs; ++r) {
+				oss << (r == rung ? "[x" : " x") << ladder[r] << (r == rung ? "]" : " ");
+			}
+			oss << "\n";
+			if (rung > 0) oss << u8"Cash out now: £" << bet * ladder[rung] << "\n";
+			if (!solved) oss << "No hint: this shoe is too deep for the solver";
+			else if (hint.takeCash) oss << u8"Hint: cash out (best play is worth £" << bet * hint.value() << ")";
+			else oss << "Hint: guess " << (hint.guess == 'H' ? "Higher" : "Lower") << u8" (best play is worth £" << bet * hint.value() << ")";
+			drawAsciiBox(out, oss.str());
+		});
+	}
+
+	// Streak mode: keep guessing from the same deck, cash out at any rung
+	static const KeyMap& guessKeys() {
+		static const KeyMap keys{ { 'h', Action::Higher }, { 'l', Action::Lower } };
+		return keys;
+	}
+	static const KeyMap& ladderKeys() {
+		static const KeyMap keys = KeyMap(guessKeys()).bind('c', Action::CashOut);
+		return keys;
+	}
 
-	void displayCardOne(const Card& c) const {
-		auto art = c.displayCard();
-		for (auto& L : art) std::cout << L << "\n";
+	Task<void> playLadder(Player& player, CasinoManager& casino, double bet) {
+		const int rungs = HighLowLadderSolver::rungs;
+		if (deck.remaining() < static_cast<size_t>(rungs + 1)) {
+			view.box("Deck running low. Reshuffling.");
+			reshuffle();
+		}
+
+		Card current = dealTracked();
+		int rung = 0;
+		while (true) {
+			showCard("\nCurrent card:\n", current, true);
+			showLadder(rung, bet, current);
+
+			const Action choice = rung > 0 ? co_await casino.input.readAction("(H)igher, (L)ower or (C)ash out? ", ladderKeys()) : co_await casino.input.readAction("(H)igher or (L)ower? ", guessKeys());
+			if (choice == Action::CashOut) {
+				view.box("You cash out on rung ", rung, ".");
+				casino.processWin(bet, solver.paytable()[rung], View::enabled);
+				co_return;
+			}
+			char ch = choice == Action::Higher ? 'H' : 'L';
+
+			// Muddled Sight can flip the choice
+			if (player.hasCurse("Muddled Sight") && randint(1, 100) <= 20) {
+				view.box("Muddled Sight flips your choice!");
+				ch = (ch == 'H') ? 'L' : 'H';
+			}
+
+			Card next = drawCardForPlayer(deck, player);
+			remaining.remove(next.getRank());
+			showCard("\nNext card:\n", next, false);
+
+			const int vcur = static_cast<int>(current.getRank());
+			const int vnext = static_cast<int>(next.getRank());
+			if (!((vnext > vcur && ch == 'H') || (vnext < vcur && ch == 'L'))) {
+				view.box(vnext == vcur ? "Tie. The house takes ties on the ladder." : "Wrong guess. The ladder collapses.");
+				maybeApplyRandomCurseAfterLoss(player, View::enabled);
+				casino.processLoss(bet, View::enabled);
+				co_return;
+			}
+
+			current = next;
+			if (++rung == rungs) {
+				view.box("Top of the ladder!");
+				casino.processWin(bet, solver.paytable()[rung], View::enabled);
+				co_return;
+			}
+		}
 	}
 
 public:
-	void play(Player& player, CasinoManager &casino) {
-		drawAsciiBox("=== High / Low ===");
+	Task<void> play(Player& player, CasinoManager &casino) {
+		TraceSpan span("HighLow::play");
+		InputSource& input = casino.input;
+		view.box("=== High / Low ===");
 
-		player.showStatus();
+		if (!modeChosen) {
+			view.print("1 Classic (fresh shuffle every round)\n2 Classic, same deck between rounds\n3 Ladder (streak with cash-out)\n");
+			mode = static_cast<Mode>(co_await input.readChoice("Choose mode: ", 1, 3));
+			persistentDeck = mode != Classic;
+			modeChosen = true;
+			reshuffle();
+		}
+
+		view.status(player);
 
 		// Blessings prompt
-		std::string cast = readLineTrimmed("Cast a Blessing before this round? (y/n) ");
-		if (!cast.empty() && (cast[0] == 'y' || cast[0] == 'Y')) {
-			std::cout << "1 Fate's Glimpse (15)\n2 Lucky Draw (20)\n3 Mana Shield (10)\n0 Skip\n";
-			int pick = readInt("Choose: ", 0, 3);
-			if (pick == 1) player.castBlessing("Fate's Glimpse");
-			else if (pick == 2) player.castBlessing("Lucky Draw");
-			else if (pick == 3) player.castBlessing("Mana Shield");
+		const bool bless = co_await input.readYesNo("Cast a Blessing before this round? (y/n) ");
+		if (bless) {
+			view.print("1 Fate's Glimpse (15)\n2 Lucky Draw (20)\n3 Mana Shield (10)\n0 Skip\n");
+			int pick = co_await input.readChoice("Choose: ", 0, 3);
+			if (pick == 1) player.castBlessing("Fate's Glimpse", View::enabled);
+			else if (pick == 2) player.castBlessing("Lucky Draw", View::enabled);
+			else if (pick == 3) player.castBlessing("Mana Shield", View::enabled);
 		}
 
 		// Place bet
 		double bet;
-		if (!casino.placeBet(bet)) { pauseEnter(); return; }
+		const bool placed = co_await casino.placeBet(bet, 10, 1000, View::enabled);
+		if (!placed) { co_await input.pauseEnter(); co_return; }
 
-		deck.shuffle();
+		if (mode == Ladder) {
+			co_await playLadder(player, casino, bet);
+			// The next ladder's first hint, worked out before the player is asked
+			// anything; a deck too short for it is reshuffled (and warmed) instead
+			if (deck.remaining() >= static_cast<size_t>(HighLowLadderSolver::rungs + 1)) solver.warm(remaining);
+			player.regenerateMana();
+			player.decayCurses(View::enabled);
+			player.clearBlessings();
+			co_await input.pauseEnter();
+			view.status(player);
+			co_return;
+		}
 
-		Card current = deck.dealCard();
-		std::cout << "\nCurrent card:\n";
-		displayCardOne(current);
+		// Without a persistent deck every round starts from a fresh shuffle
+		if (!persistentDeck || deck.remaining() < 2) {
+			if (persistentDeck) view.box("Deck exhausted. Reshuffling.");
+			reshuffle();
+		}
+
+		Card current = dealTracked();
+		showCard("\nCurrent card:\n", current, true);
 
 		// player choice H/L
-		std::string choice = readLineTrimmed("Will the next card be (H)igher or (L)ower? ");
-		if (choice.empty()) { drawAsciiBox("No choice — round aborted."); player.refundCurrentBet(); pauseEnter(); return; }
-		char ch = std::toupper(choice[0]);
+		char ch = co_await input.readAction("Will the next card be (H)igher or (L)ower? ", guessKeys()) == Action::Higher ? 'H' : 'L';
 
 		// Muddled Sight can flip the choice
 		if (player.hasCurse("Muddled Sight") && randint(1, 100) <= 20) {
-			drawAsciiBox("Muddled Sight flips your choice!");
+			view.box("Muddled Sight flips your choice!");
 			ch = (ch == 'H') ? 'L' : 'H';
 		}
 
 		// Next card uses drawCardForPlayer (Lucky Draw interacts)
 		Card next = drawCardForPlayer(deck, player);
+		remaining.remove(next.getRank());
 
-		std::cout << "\nNext card:\n";
-		displayCardOne(next);
+		showCard("\nNext card:\n", next, false);
 
 		int vcur = static_cast<int>(current.getRank());
 		int vnext = static_cast<int>(next.getRank());
 
 		if (vnext == vcur) {
-			drawAsciiBox("Tie — bet returned.");
+			view.box("Tie — bet returned.");
 			player.refundCurrentBet();
 		}
 		else if ((vnext > vcur && ch == 'H') || (vnext < vcur && ch == 'L')) {
-			drawAsciiBox("You win!");
-			casino.processWin(bet, 2.0);
+			view.box("You win!");
+			casino.processWin(bet, 2.0, View::enabled);
 		}
 		else {
-			drawAsciiBox("You lose.");
-			maybeApplyRandomCurseAfterLoss(player);
-			casino.processLoss(bet);
+			view.box("You lose.");
+			maybeApplyRandomCurseAfterLoss(player, View::enabled);
+			casino.processLoss(bet, View::enabled);
 		}
 
 		player.regenerateMana();
-		player.decayCurses();
+		player.decayCurses(View::enabled);
 		player.clearBlessings();
-		pauseEnter();
-		showRoundSummary(player);
+		co_await input.pauseEnter();
+		view.status(player);
 	}
 };
+
+using HighLow = BasicHighLow<ConsoleView>;
+inline const bool highLowRegistered = registerGame<HighLow, BasicHighLow<NullView>>({ "High-Low", "High-Low", 4, KeepsShoe | Blessings });
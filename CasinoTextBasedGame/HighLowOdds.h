@@ -0,0 +1,311 @@
+﻿#pragma once
+#include "Main.h"
+#include "JobScheduler.h"
+#include <array>
+#include <cstdint>
+
+//================== Rank Histogram ==================//
+//------Undealt cards per rank, kept in step with every deal-------//
+struct RankHistogram {
+	std::array<int, Card::Ace + 1> counts{}; // indexed by Card::Rank (Two..Ace)
+	int total = 0;
+
+	struct Odds {
+		double higher = 0.0;
+		double lower = 0.0;
+		double tie = 0.0;
+	};
+
+	// Full recount; only needed after a shuffle
+	void reset(const Deck& deck) {
+		counts.fill(0);
+		total = 0;
+		deck.forEachRemaining([&](const Card& c) { counts[c.getRank()]++; total++; });
+	}
+	void fill(int decks = 1) {
+		counts.fill(0);
+		for (int r = Card::Two; r <= Card::Ace; ++r) counts[r] = 4 * decks;
+		total = 52 * decks;
+	}
+	// O(1) per dealt card
+	void remove(int rank) {
+		counts[rank]--;
+		total--;
+	}
+
+	// Chance the next card is higher / lower / equal to `shown`
+	Odds against(int shown) const {
+		Odds o;
+		if (total <= 0) return o;
+		int below = 0;
+		for (int r = Card::Two; r < shown; ++r) below += counts[r];
+		const int same = counts[shown];
+		o.lower = static_cast<double>(below) / total;
+		o.tie = static_cast<double>(same) / total;
+		o.higher = static_cast<double>(total - below - same) / total;
+		return o;
+	}
+};
+
+//================== High-Low Bot ==================//
+//------Guesses whichever side the histogram favours-------//
+struct HighLowBot {
+	char guess(const RankHistogram& h, int shown) const {
+		RankHistogram::Odds o = h.against(shown);
+		return (o.higher >= o.lower) ? 'H' : 'L';
+	}
+};
+
+struct HighLowSimResult {
+	uint64_t rounds = 0;
+	uint64_t wins = 0;
+	uint64_t losses = 0;
+	uint64_t ties = 0;
+	double wagered = 0.0;
+	double returned = 0.0;
+
+	double rtp() const { return wagered > 0.0 ? returned / wagered : 0.0; }
+
+	HighLowSimResult& operator+=(const HighLowSimResult& o) {
+		rounds += o.rounds; wins += o.wins; losses += o.losses; ties += o.ties;
+		wagered += o.wagered; returned += o.returned;
+		return *this;
+	}
+};
+
+// Bot play on a flat rank array; win pays 2x, a tie returns the stake.
+// persistentDeck keeps dealing from the same deck until it runs out.
+inline HighLowSimResult playHighLowBot(uint64_t rounds, uint32_t seed, bool persistentDeck) {
+	std::mt19937 gen(seed);
+	uint8_t cards[52];
+	for (int i = 0; i < 52; ++i) cards[i] = static_cast<uint8_t>(Card::Two + i % 13);
+
+	RankHistogram hist;
+	HighLowBot bot;
+	HighLowSimResult res;
+	int pos = 52;
+
+	for (uint64_t i = 0; i < rounds; ++i) {
+		if (!persistentDeck) {
+			// A round only sees two cards: a two-step partial Fisher-Yates is a full shuffle's worth
+			for (int k = 0; k < 2; ++k) std::swap(cards[k], cards[std::uniform_int_distribution<int>(k, 51)(gen)]);
+			hist.fill();
+			pos = 0;
+		}
+		else if (pos > 50) {
+			std::shuffle(cards, cards + 52, gen);
+			hist.fill();
+			pos = 0;
+		}
+		const int current = cards[pos++];
+		hist.remove(current);
+		const char g = bot.guess(hist, current);
+		const int next = cards[pos++];
+		hist.remove(next);
+
+		++res.rounds;
+		res.wagered += 1.0;
+		if (next == current) { ++res.ties; res.returned += 1.0; }
+		else if ((next > current) == (g == 'H')) { ++res.wins; res.returned += 2.0; }
+		else ++res.losses;
+	}
+	return res;
+}
+
+// The same on the job scheduler; each chunk of rounds starts from its own deck
+inline HighLowSimResult simulateHighLowBot(uint64_t rounds, uint32_t seed, bool persistentDeck, JobScheduler& jobs = jobScheduler()) {
+	return jobs.parallelReduce(rounds, 1u << 18, HighLowSimResult(),
+		[seed, persistentDeck](const JobScheduler::Slice& s) { return playHighLowBot(s.size(), s.seed(seed), persistentDeck); },
+		[](HighLowSimResult& total, const HighLowSimResult& part) { total += part; });
+}
+
+//================== High-Low Ladder Solver ==================//
+//------Exact continue / cash-out decisions, memoised over deck composition-------//
+// Ladder rules: after the first card the player guesses higher or lower; a tie
+// loses. Each correct guess climbs one rung, and the player may cash out at
+// ladder[rung] x bet before any later guess. Reaching the top rung cashes out.
+//
+// A state is (undealt composition, shown rank, rung). The last two rungs are
+// closed-form, so only the shallower states go in the memo table. The table is
+// keyed on the full composition and survives between queries and ladders, so
+// every later rung of a ladder is a lookup, and warm() between ladders makes
+// the first hint of the next one a lookup too. Call clear() after a reshuffle:
+// states of the old deck never come up again.
+//
+// Compositions are packed 4 bits per rank, so a rank may have at most
+// maxPerRank undealt cards (three decks); advise() refuses larger shoes.
+class HighLowLadderSolver {
+public:
+	static constexpr int rungs = 6;
+	static constexpr int maxPerRank = 15;
+	using Ladder = std::array<double, rungs + 1>;
+
+	static Ladder defaultLadder() { return Ladder{ { 0.0, 1.25, 1.6, 2.0, 2.6, 3.4, 4.5 } }; }
+
+	struct Advice {
+		double cashOut = 0.0;      // value of stopping now (per unit bet); 0 before the first guess
+		double higher = 0.0;       // value of guessing higher then playing on optimally
+		double lower = 0.0;
+		char guess = 'H';
+		bool takeCash = false;
+		double value() const { return takeCash ? cashOut : std::max(higher, lower); }
+	};
+
+	explicit HighLowLadderSolver(const Ladder& l = defaultLadder()) : ladder(l) {
+		slots.assign(1u << 16, Slot());
+	}
+
+	const Ladder& paytable() const { return ladder; }
+	size_t memoSize() const { return used; }
+	void clear() { slots.assign(1u << 16, Slot()); used = 0; }
+
+	// `remaining` must already exclude the shown card. False, with `a` left
+	// alone, if a rank has more than maxPerRank cards left.
+	bool advise(const RankHistogram& remaining, int shownRank, int rung, Advice& a) {
+		if (!load(remaining)) return false;
+		const int cur = shownRank - Card::Two;
+		a = Advice();
+		a.cashOut = cashValue(rung);
+		if (rung >= rungs || total == 0) { a.takeCash = true; return true; }
+		guessValues(cur, rung, a.higher, a.lower);
+		a.guess = (a.higher >= a.lower) ? 'H' : 'L';
+		a.takeCash = rung > 0 && a.cashOut >= std::max(a.higher, a.lower);
+		return true;
+	}
+
+	// Solves the first rung of the next ladder for every card that could start
+	// it from `remaining`, so its hints are all lookups. Takes a few ms on a
+	// fresh deck; call it between ladders, not while a hint is awaited.
+	void warm(const RankHistogram& remaining) {
+		Advice a;
+		for (int r = Card::Two; r <= Card::Ace; ++r) {
+			if (!remaining.counts[r]) continue;
+			RankHistogram after = remaining;
+			after.remove(r);
+			if (!advise(after, r, 0, a)) return;
+		}
+	}
+
+	// Exact return to player from a fresh single deck under optimal play
+	double exactRtp() {
+		RankHistogram fresh;
+		double ev = 0.0;
+		Advice a;
+		for (int r = Card::Two; r <= Card::Ace; ++r) {
+			fresh.fill();
+			fresh.remove(r);
+			advise(fresh, r, 0, a);
+			ev += a.value() / 13.0;
+		}
+		return ev;
+	}
+
+private:
+	struct Slot {
+		uint64_t key = ~0ULL;
+		double value = 0.0;
+	};
+	static constexpr size_t maxSlots = size_t(1) << 23;
+
+	Ladder ladder;
+	std::vector<Slot> slots;
+	size_t used = 0;
+	int cnt[13] = {};
+	int total = 0;
+	uint64_t comp = 0; // 4 bits per rank
+
+	bool load(const RankHistogram& h) {
+		total = 0;
+		comp = 0;
+		for (int i = 0; i < 13; ++i) {
+			cnt[i] = h.counts[Card::Two + i];
+			if (cnt[i] < 0 || cnt[i] > maxPerRank) return false;
+			total += cnt[i];
+			comp |= static_cast<uint64_t>(cnt[i]) << (4 * i);
+		}
+		return true;
+	}
+
+	double cashValue(int rung) const { return rung > 0 ? ladder[rung] : 0.0; }
+
+	// Value of guessing each way from `cur` at `rung`, given the loaded composition
+	void guessValues(int cur, int rung, double& hi, double& lo) {
+		hi = lo = 0.0;
+		if (rung + 1 == rungs) {
+			// Next correct guess tops out the ladder
+			int below = 0;
+			for (int r = 0; r < cur; ++r) below += cnt[r];
+			const int above = total - below - cnt[cur];
+			hi = ladder[rungs] * above / total;
+			lo = ladder[rungs] * below / total;
+			return;
+		}
+		if (rung + 2 == rungs) {
+			// Children sit one rung below the top: their value is closed-form from prefix counts
+			int prefix[14];
+			prefix[0] = 0;
+			for (int r = 0; r < 13; ++r) prefix[r + 1] = prefix[r] + cnt[r];
+			const int left = total - 1;
+			for (int r = 0; r < 13; ++r) {
+				if (!cnt[r] || r == cur) continue;
+				const int below = prefix[r];
+				const int above = left - below - (cnt[r] - 1);
+				// With no card left to guess at, the player banks the rung just reached
+				const double child = left == 0 ? ladder[rungs - 1]
+					: std::max(ladder[rungs - 1], ladder[rungs] * std::max(above, below) / left);
+				(r > cur ? hi : lo) += cnt[r] * child;
+			}
+			hi /= total;
+			lo /= total;
+			return;
+		}
+		for (int r = 0; r < 13; ++r) {
+			if (!cnt[r] || r == cur) continue;
+			const double w = cnt[r];
+			cnt[r]--; total--; comp -= 1ULL << (4 * r);
+			const double child = value(r, rung + 1);
+			cnt[r]++; total++; comp += 1ULL << (4 * r);
+			(r > cur ? hi : lo) += w * child;
+		}
+		hi /= total;
+		lo /= total;
+	}
+
+	double value(int cur, int rung) {
+		if (total == 0) return cashValue(rung);
+		const uint64_t key = (comp << 7) | (static_cast<uint64_t>(cur) << 3) | static_cast<uint64_t>(rung);
+		size_t i = probe(key);
+		if (slots[i].key == key) return slots[i].value;
+
+		double hi, lo;
+		guessValues(cur, rung, hi, lo);
+		const double v = std::max(cashValue(rung), std::max(hi, lo));
+
+		if ((used + 1) * 2 > slots.size()) {
+			if (slots.size() >= maxSlots) clear(); // bounded: start over rather than grow forever
+			else grow();
+			i = probe(key);
+		}
+		slots[i].key = key;
+		slots[i].value = v;
+		++used;
+		return v;
+	}
+
+	size_t probe(uint64_t key) const {
+		const size_t mask = slots.size() - 1;
+		size_t i = static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> 20) & mask;
+		while (slots[i].key != ~0ULL && slots[i].key != key) i = (i + 1) & mask;
+		return i;
+	}
+
+	void grow() {
+		std::vector<Slot> old;
+		old.swap(slots);
+		slots.assign(old.size() * 2, Slot());
+		for (const Slot& s : old) {
+			if (s.key == ~0ULL) continue;
+			slots[probe(s.key)] = s;
+		}
+	}
+};
@@ -0,0 +1,361 @@
+﻿#pragma once
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <initializer_list>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#ifdef _WIN32
+#include <conio.h>
+#include <io.h>
+#else
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+#include "Coroutine.h"
+
+//================== Keyboard Input ==================//
+//------What a key means at a prompt-------//
+enum class Action : unsigned char {
+    None,
+    Yes, No,
+    Hit, Stand, Double, Surrender,
+    Higher, Lower, CashOut,
+    Choice0, Choice1, Choice2, Choice3, Choice4, Choice5, Choice6, Choice7, Choice8, Choice9
+};
+
+inline Action choiceAction(int n) { return static_cast<Action>(static_cast<int>(Action::Choice0) + n); }
+inline bool isChoice(Action a) { return a >= Action::Choice0 && a <= Action::Choice9; }
+inline int choiceNumber(Action a) { return static_cast<int>(a) - static_cast<int>(Action::Choice0); }
+
+//------Key bindings-------//
+// A table from key to action; keys that are not bound are ignored at the
+// prompt. Letters are bound in both cases.
+class KeyMap {
+public:
+    KeyMap() = default;
+    KeyMap(std::initializer_list<std::pair<char, Action>> bindings) {
+        for (const auto& b : bindings) bind(b.first, b.second);
+    }
+
+    KeyMap& bind(char key, Action action) {
+        const unsigned char k = static_cast<unsigned char>(key);
+        if (k >= table.size()) return *this;
+        table[k] = action;
+        bound |= 1u << static_cast<unsigned>(action);
+        if (k >= 'a' && k <= 'z') table[k - 'a' + 'A'] = action;
+        else if (k >= 'A' && k <= 'Z') table[k - 'A' + 'a'] = action;
+        return *this;
+    }
+
+    // Digits minv..maxv (0-9) as Choice actions
+    static KeyMap choices(int minv, int maxv) {
+        KeyMap keys;
+        for (int n = minv < 0 ? 0 : minv; n <= (maxv > 9 ? 9 : maxv); ++n) keys.bind(static_cast<char>('0' + n), choiceAction(n));
+        return keys;
+    }
+
+    Action operator[](int key) const {
+        return key >= 0 && key < static_cast<int>(table.size()) ? table[key] : Action::None;
+    }
+
+    // Whether some key leads to `action`; lets a bot see what a prompt accepts
+    bool has(Action action) const { return action != Action::None && ((bound >> static_cast<unsigned>(action)) & 1u); }
+
+private:
+    std::array<Action, 128> table{};
+    uint32_t bound = 0;
+};
+
+// Digit keys minv..maxv, built once per range
+inline const KeyMap& choiceKeys(int minv, int maxv) {
+    static const std::array<KeyMap, 100> maps = [] {
+        std::array<KeyMap, 100> m;
+        for (int lo = 0; lo < 10; ++lo)
+            for (int hi = lo; hi < 10; ++hi) m[lo * 10 + hi] = KeyMap::choices(lo, hi);
+        return m;
+    }();
+    const auto digit = [](int n) { return n < 0 ? 0 : n > 9 ? 9 : n; };
+    return maps[digit(minv) * 10 + digit(maxv)];
+}
+
+inline const KeyMap& yesNoKeys() {
+    static const KeyMap keys{ { 'y', Action::Yes }, { 'n', Action::No } };
+    return keys;
+}
+
+//------Raw-mode keyboard-------//
+// When stdin is a terminal it is switched out of line mode for the whole
+// session: every keystroke arrives on its own, unechoed, the moment it is
+// typed, so a prompt can act on one key without waiting for Enter. Lines of
+// text (names, bets) are then read here too, with their own echo and
+// backspace. The terminal is put back on exit and on a fatal signal.
+//
+// When stdin is a pipe or a file, input stays line based so scripts keep
+// working: a key prompt takes one line and uses its first non-blank
+// character, an empty line standing for Enter.
+//
+// Every read is a Task that waits on this thread's event loop for stdin, so
+// the console is driven like any other session. (On Windows the console
+// cannot be polled, and reads block as before.)
+class Keyboard {
+public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr int endOfInput = -1;
+    static constexpr int noKey = -2;
+
+    Keyboard() {
+#ifdef _WIN32
+        raw = _isatty(_fileno(stdin)) != 0;
+#else
+        raw = isatty(STDIN_FILENO) && tcgetattr(STDIN_FILENO, &saved) == 0;
+        if (!raw) return;
+        keyMode = saved;
+        keyMode.c_lflag &= ~(ICANON | ECHO);
+        keyMode.c_cc[VMIN] = 1;
+        keyMode.c_cc[VTIME] = 0;
+        tcsetattr(STDIN_FILENO, TCSANOW, &keyMode);
+        rawActive = 1;
+        for (int sig : { SIGINT, SIGTERM, SIGHUP, SIGQUIT }) std::signal(sig, restoreAndReraise);
+        std::signal(SIGCONT, reapplyKeyMode);
+#endif
+    }
+    ~Keyboard() { restore(); }
+    Keyboard(const Keyboard&) = delete;
+    Keyboard& operator=(const Keyboard&) = delete;
+
+    // True when keys arrive one at a time from a terminal
+    bool interactive() const { return raw; }
+
+    // The next key. Enter reads as '\n'; endOfInput once stdin is closed.
+    Task<int> key() {
+        if (!raw) {
+            std::string line;
+            const bool got = co_await rawLine(line);
+            if (!got) co_return endOfInput;
+            const auto at = line.find_first_not_of(" \t\r");
+            co_return at == std::string::npos ? '\n' : static_cast<unsigned char>(line[at]);
+        }
+        for (;;) {
+            const int k = co_await nextKey(EventLoop::never);
+            if (k != noKey) co_return k;
+        }
+    }
+
+    // The next key if one is typed before `deadline`, else noKey. Never reads
+    // a pipe: scripted input belongs to prompts, so this just waits there.
+    Task<int> keyBefore(Clock::time_point deadline) {
+        if (!raw) {
+            co_await eventLoop().sleepUntil(deadline);
+            co_return noKey;
+        }
+        for (;;) {
+            const int k = co_await nextKey(deadline);
+            if (k != noKey || Clock::now() >= deadline) co_return k;
+        }
+    }
+
+    // Drops anything typed ahead, so a burst of keys cannot answer the next prompt
+    void discardTypeahead() {
+        if (!raw) return;
+        head = tail = 0;
+#ifdef _WIN32
+        while (_kbhit()) (void)_getch();
+#else
+        while (fillNow() > 0) head = tail = 0;
+#endif
+    }
+
+    // A line of text without its newline; false once stdin is closed
+    Task<bool> line(std::string& line) {
+        line.clear();
+        if (!raw) co_return co_await rawLine(line);
+#ifdef _WIN32
+        co_return static_cast<bool>(std::getline(std::cin, line));
+#else
+        for (;;) {
+            // Bytes already buffered are taken without a coroutine call
+            const int c = head < tail ? static_cast<unsigned char>(buffer[head++]) : co_await nextByte(EventLoop::never);
+            if (c == noKey) continue;
+            if (c == endOfInput || (c == 0x04 && line.empty())) co_return false;
+            if (c == '\r' || c == '\n') {
+                echo("\n");
+                co_return true;
+            }
+            if (c == 0x7f || c == '\b') {
+                if (line.empty()) continue;
+                // Drop one whole UTF-8 codepoint
+                while (!line.empty() && (static_cast<unsigned char>(line.back()) & 0xC0) == 0x80) line.pop_back();
+                if (!line.empty()) line.pop_back();
+                echo("\b \b");
+            }
+            else if (c == 0x1b) {
+                co_await skipEscapeSequence();
+            }
+            else if (c >= 0x20) {
+                line += static_cast<char>(c);
+                const char ch = static_cast<char>(c);
+                echo(std::string_view(&ch, 1));
+            }
+        }
+#endif
+    }
+
+private:
+    bool raw = false;
+    char buffer[256];
+    int head = 0, tail = 0;
+    bool closed = false;
+
+#ifndef _WIN32
+    termios keyMode{};
+    static inline termios saved{};
+    static inline volatile std::sig_atomic_t rawActive = 0;
+
+    static void restoreAndReraise(int sig) {
+        if (rawActive) tcsetattr(STDIN_FILENO, TCSANOW, &saved);
+        std::signal(sig, SIG_DFL);
+        std::raise(sig);
+    }
+
+    // After a Ctrl-Z and fg the shell has put the terminal back in line mode
+    static void reapplyKeyMode(int) {
+        if (!rawActive) return;
+        termios mode = saved;
+        mode.c_lflag &= ~(ICANON | ECHO);
+        mode.c_cc[VMIN] = 1;
+        mode.c_cc[VTIME] = 0;
+        tcsetattr(STDIN_FILENO, TCSANOW, &mode);
+    }
+
+    // Reads whatever is waiting without blocking; >0 read, 0 nothing, <0 closed
+    int fillNow() {
+        if (closed) return -1;
+        pollfd in{ STDIN_FILENO, POLLIN, 0 };
+        if (poll(&in, 1, 0) <= 0) return 0;
+        const ssize_t n = read(STDIN_FILENO, buffer + tail, sizeof buffer - tail);
+        if (n <= 0) {
+            closed = true;
+            return -1;
+        }
+        tail += static_cast<int>(n);
+        return static_cast<int>(n);
+    }
+#endif
+
+    void restore() {
+#ifndef _WIN32
+        if (!rawActive) return;
+        tcsetattr(STDIN_FILENO, TCSANOW, &saved);
+        rawActive = 0;
+#endif
+    }
+
+    static void echo(std::string_view text) {
+        std::cout.write(text.data(), static_cast<std::streamsize>(text.size()));
+        std::cout.flush();
+    }
+
+    // One byte from stdin; noKey if none came by the deadline
+    Task<int> nextByte(Clock::time_point deadline) {
+#ifdef _WIN32
+        if (deadline != EventLoop::never) {
+            while (!_kbhit()) {
+                if (Clock::now() >= deadline) co_return noKey;
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+        }
+        co_return _getch();
+#else
+        if (head == tail) {
+            head = tail = 0;
+            if (closed) co_return endOfInput;
+            const short events = co_await eventLoop().ready(STDIN_FILENO, POLLIN, deadline);
+            if (!events) co_return noKey;
+            const ssize_t n = read(STDIN_FILENO, buffer, sizeof buffer);
+            if (n < 0 && errno == EINTR) co_return noKey;
+            if (n <= 0) {
+                closed = true;
+                co_return endOfInput;
+            }
+            tail = static_cast<int>(n);
+        }
+        co_return static_cast<unsigned char>(buffer[head++]);
+#endif
+    }
+
+    // One keypress: '\r' reads as '\n', cursor and function keys are swallowed
+    Task<int> nextKey(Clock::time_point deadline) {
+        const int c = co_await nextByte(deadline);
+#ifdef _WIN32
+        if (c == 0 || c == 0xE0) { (void)_getch(); co_return noKey; }
+        if (c == 0x03) { std::raise(SIGINT); co_return noKey; }
+        if (c == 0x1A) co_return endOfInput;
+#else
+        if (c == 0x04) co_return endOfInput;
+        if (c == 0x1b) { co_await skipEscapeSequence(); co_return noKey; }
+#endif
+        co_return c == '\r' ? '\n' : c;
+    }
+
+    // ESC [ ... final  or  ESC O x, as sent by arrow and function keys
+    Task<void> skipEscapeSequence() {
+#ifndef _WIN32
+        int c = co_await nextByte(Clock::now());
+        if (c == 'O') { (void)co_await nextByte(Clock::now()); co_return; }
+        if (c != '[') co_return;
+        do c = co_await nextByte(Clock::now()); while (c >= 0x20 && c < 0x40);
+#else
+        co_return;
+#endif
+    }
+
+    // Line mode: bytes up to the newline, with any '\r' dropped
+    Task<bool> rawLine(std::string& line) {
+        bool any = false;
+        for (;;) {
+#ifdef _WIN32
+            char ch;
+            const int c = _read(0, &ch, 1) == 1 ? static_cast<unsigned char>(ch) : endOfInput;
+#else
+            // Bytes already buffered are taken without a coroutine call
+            const int c = head < tail ? static_cast<unsigned char>(buffer[head++]) : co_await nextByte(EventLoop::never);
+            if (c == noKey) continue;
+#endif
+            if (c == endOfInput) co_return any;
+            any = true;
+            if (c == '\n') co_return true;
+            if (c != '\r') line += static_cast<char>(c);
+        }
+    }
+};
+
+// The process-wide keyboard; its first use puts a terminal stdin in key mode
+inline Keyboard& keyboard() {
+    static Keyboard k;
+    return k;
+}
+
+// Thrown by inputClosed() on server threads, where one player leaving must not
+// end the process. Not a std::exception, so a game's own catch lets it through.
+struct SessionClosed {};
+
+// True on threads that run server sessions
+inline bool& inputEndsSession() {
+    thread_local bool sessionThread = false;
+    return sessionThread;
+}
+
+// Out of input (Ctrl-D, the end of a script, a client hanging up): leave the casino cleanly
+[[noreturn]] inline void inputClosed() {
+    if (inputEndsSession()) throw SessionClosed{};
+    std::cout << "\nInput closed. Goodbye!\n";
+    std::exit(0);
+}
@@ -0,0 +1,313 @@
+﻿#pragma once
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include "Input.h"
+#include "Metrics.h"
+
+//================== Input Sources ==================//
+//------What the player is being asked-------//
+// Every decision in the casino is one of these. A person reads `text`; a bot
+// looks at what is accepted instead: the bound actions of a key prompt, or
+// the range of a number.
+struct Prompt {
+    enum Kind { Key, Number, Text, Pause };
+    Kind kind;
+    std::string_view text;
+    const KeyMap* keys = nullptr; // Key
+    double minv = 0.0;            // Number
+    double maxv = 0.0;
+    bool whole = false;           // Number: integers only
+};
+
+//------Where the answers come from-------//
+// Games, the menu and CasinoManager ask through an InputSource and never
+// touch stdin. ConsoleInput is the keyboard, ScriptInput replays a file and
+// BotInput calls into code, so the same game runs for a person, a regression
+// script or a soak test. Each source returns Action::None / false once it has
+// run out; the read* calls turn that into the end of the session.
+//
+// Every answer is a Task to co_await. The keyboard and a socket suspend the
+// asking coroutine until the player replies; a script or a bot answers
+// without suspending. The prompt text must outlive the co_await, which it
+// does when the call is awaited in the same expression that builds it.
+class InputSource {
+public:
+    virtual ~InputSource() = default;
+
+    virtual Task<Action> key(const Prompt& prompt) = 0;
+    virtual Task<bool> number(const Prompt& prompt, double& value) = 0;
+    virtual Task<bool> text(const Prompt& prompt, std::string& line) = 0;
+    virtual Task<bool> pause(const Prompt& prompt) = 0;
+
+    // One of the actions bound in `keys`
+    // Each answer is timed as a Decide sample, from the prompt to the reply
+    Task<Action> readAction(std::string_view text, const KeyMap& keys) {
+        PhaseTimer timing(Phase::Decide);
+        const Action action = co_await key(Prompt{ Prompt::Key, text, &keys });
+        if (action == Action::None) inputClosed();
+        co_return action;
+    }
+
+    Task<bool> readYesNo(std::string_view text) { co_return co_await readAction(text, yesNoKeys()) == Action::Yes; }
+
+    // A single digit in minv..maxv (both 0-9)
+    Task<int> readChoice(std::string_view text, int minv, int maxv) { co_return choiceNumber(co_await readAction(text, choiceKeys(minv, maxv))); }
+
+    Task<int> readInt(std::string_view text, int minv, int maxv) {
+        PhaseTimer timing(Phase::Decide);
+        double value = 0.0;
+        const bool got = co_await number(Prompt{ Prompt::Number, text, nullptr, static_cast<double>(minv), static_cast<double>(maxv), true }, value);
+        if (!got) inputClosed();
+        co_return static_cast<int>(value);
+    }
+
+    Task<double> readDouble(std::string_view text, double minv, double maxv) {
+        PhaseTimer timing(Phase::Decide);
+        double value = 0.0;
+        const bool got = co_await number(Prompt{ Prompt::Number, text, nullptr, minv, maxv, false }, value);
+        if (!got) inputClosed();
+        co_return value;
+    }
+
+    // A line of text with the surrounding blanks trimmed
+    Task<std::string> readLineTrimmed(std::string_view text = "") {
+        std::string line;
+        const bool got = co_await this->text(Prompt{ Prompt::Text, text }, line);
+        if (!got) inputClosed();
+        const auto l = line.find_first_not_of(" \t\r\n");
+        if (l == std::string::npos) co_return "";
+        const auto r = line.find_last_not_of(" \t\r\n");
+        co_return line.substr(l, r - l + 1);
+    }
+
+    Task<void> pauseEnter(std::string_view text = "Press any key to continue...") {
+        const bool got = co_await pause(Prompt{ Prompt::Pause, text });
+        if (!got) inputClosed();
+    }
+
+protected:
+    enum class Parse { Ok, NotANumber, OutOfRange };
+
+    // Reads `line` as the answer to a Number prompt
+    static Parse parseNumber(const std::string& line, const Prompt& prompt, double& value) {
+        const auto l = line.find_first_not_of(" \t");
+        if (l == std::string::npos) return Parse::NotANumber;
+        const char* begin = line.c_str() + l;
+        char* end = nullptr;
+        value = prompt.whole ? static_cast<double>(std::strtol(begin, &end, 10)) : std::strtod(begin, &end);
+        while (*end == ' ' || *end == '\t') ++end;
+        if (end == begin || *end != '\0') return Parse::NotANumber;
+        if (value < prompt.minv || value > prompt.maxv) return Parse::OutOfRange;
+        return Parse::Ok;
+    }
+
+    static void describeParseError(std::ostream& out, Parse error, const Prompt& prompt) {
+        if (error == Parse::NotANumber) out << (prompt.whole ? "Invalid input. Enter an integer.\n" : "Invalid input. Enter a number.\n");
+        else out << "Enter a number between " << prompt.minv << " and " << prompt.maxv << ".\n";
+    }
+};
+
+//------The keyboard-------//
+// Prompts are printed and answered through the raw-mode keyboard (Input.h):
+// one keypress for a key prompt, a line for numbers and text.
+class ConsoleInput : public InputSource {
+public:
+    Task<Action> key(const Prompt& prompt) override {
+        Keyboard& kb = keyboard();
+        show(prompt.text);
+        for (;;) {
+            const int k = co_await kb.key();
+            if (k == Keyboard::endOfInput) co_return Action::None;
+            const Action action = (*prompt.keys)[k];
+            if (action != Action::None) {
+                if (kb.interactive()) {
+                    if (k != '\n') std::cout << static_cast<char>(k);
+                    std::cout << "\n" << std::flush;
+                }
+                co_return action;
+            }
+            // Unbound keys are ignored at a terminal; a scripted line gets the prompt again
+            if (!kb.interactive()) show(prompt.text);
+        }
+    }
+
+    Task<bool> number(const Prompt& prompt, double& value) override {
+        std::string line;
+        for (;;) {
+            show(prompt.text);
+            const bool got = co_await keyboard().line(line);
+            if (!got) co_return false;
+            const Parse result = parseNumber(line, prompt, value);
+            if (result == Parse::Ok) co_return true;
+            describeParseError(std::cout, result, prompt);
+        }
+    }
+
+    Task<bool> text(const Prompt& prompt, std::string& line) override {
+        show(prompt.text);
+        co_return co_await keyboard().line(line);
+    }
+
+    Task<bool> pause(const Prompt& prompt) override {
+        show(prompt.text);
+        const int key = co_await keyboard().key();
+        if (key == Keyboard::endOfInput) co_return false;
+        if (keyboard().interactive()) std::cout << "\n" << std::flush;
+        co_return true;
+    }
+
+private:
+    static void show(std::string_view text) {
+        if (text.empty()) return;
+        std::cout.write(text.data(), static_cast<std::streamsize>(text.size()));
+        std::cout.flush();
+    }
+};
+
+// The session's keyboard input
+inline ConsoleInput& consoleInput() {
+    static ConsoleInput in;
+    return in;
+}
+
+//------A script file-------//
+// Answers one prompt per line, just as they would be typed into a pipe: a
+// key prompt takes the first non-blank character of its line and an empty
+// line is Enter. Lines starting with '#' are comments. An answer that does
+// not fit its prompt is reported with its line number on stderr and the next
+// line is tried. With echo on, prompts and answers are printed as a
+// transcript; with it off the script runs silently.
+class ScriptInput : public InputSource {
+public:
+    explicit ScriptInput(bool echo = true) : echo(echo) {}
+
+    bool open(const std::string& path, std::string& error) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            error = "Cannot open input script: " + path;
+            return false;
+        }
+        std::ostringstream all;
+        all << in.rdbuf();
+        script = all.str();
+        pos = 0;
+        lineNumber = 0;
+        return true;
+    }
+
+    void setScript(std::string text) {
+        script = std::move(text);
+        pos = 0;
+        lineNumber = 0;
+    }
+
+    // Script lines consumed so far, comments included
+    size_t linesRead() const { return lineNumber; }
+
+    Task<Action> key(const Prompt& prompt) override {
+        std::string_view line;
+        while (nextLine(prompt, line)) {
+            const auto at = line.find_first_not_of(" \t");
+            const int k = at == std::string_view::npos ? '\n' : static_cast<unsigned char>(line[at]);
+            const Action action = (*prompt.keys)[k];
+            if (action != Action::None) co_return action;
+            reject(line, "is not one of the keys");
+        }
+        co_return Action::None;
+    }
+
+    Task<bool> number(const Prompt& prompt, double& value) override {
+        std::string_view line;
+        while (nextLine(prompt, line)) {
+            const Parse result = parseNumber(std::string(line), prompt, value);
+            if (result == Parse::Ok) co_return true;
+            reject(line, result == Parse::NotANumber ? "is not a number" : "is out of range");
+        }
+        co_return false;
+    }
+
+    Task<bool> text(const Prompt& prompt, std::string& out) override {
+        std::string_view line;
+        if (!nextLine(prompt, line)) co_return false;
+        out.assign(line.data(), line.size());
+        co_return true;
+    }
+
+    Task<bool> pause(const Prompt& prompt) override {
+        std::string_view line;
+        co_return nextLine(prompt, line);
+    }
+
+private:
+    std::string script;
+    size_t pos = 0;
+    size_t lineNumber = 0;
+    bool echo;
+
+    // The next answer line, without '\r' or '\n'; comment lines are skipped
+    bool nextLine(const Prompt& prompt, std::string_view& line) {
+        while (pos < script.size()) {
+            size_t end = script.find('\n', pos);
+            if (end == std::string::npos) end = script.size();
+            line = std::string_view(script).substr(pos, end - pos);
+            if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+            pos = end + 1;
+            ++lineNumber;
+            if (!line.empty() && line[0] == '#') continue;
+            if (echo) {
+                std::cout.write(prompt.text.data(), static_cast<std::streamsize>(prompt.text.size()));
+                std::cout.write(line.data(), static_cast<std::streamsize>(line.size()));
+                std::cout << "\n";
+            }
+            return true;
+        }
+        return false;
+    }
+
+    void reject(std::string_view line, const char* why) const {
+        std::cout.flush();
+        std::cerr << "[script line " << lineNumber << "] \"" << line << "\" " << why << "; trying the next line\n";
+    }
+};
+
+//------A bot-------//
+// Answers come from code: Bot is any type with
+//   Action key(const Prompt&)          one of prompt.keys' actions, or None to stop
+//   double number(const Prompt&)       clamped into the prompt's range
+//   std::string text(const Prompt&)
+// Pauses return at once and nothing is printed, so paired with NullView games
+// a bot plays as fast as the engines run.
+template <typename Bot>
+class BotInput : public InputSource {
+public:
+    explicit BotInput(Bot b = Bot()) : bot(std::move(b)) {}
+
+    Bot& policy() { return bot; }
+
+    Task<Action> key(const Prompt& prompt) override {
+        const Action action = bot.key(prompt);
+        co_return prompt.keys->has(action) ? action : Action::None;
+    }
+
+    Task<bool> number(const Prompt& prompt, double& value) override {
+        value = bot.number(prompt);
+        if (prompt.whole) value = static_cast<double>(static_cast<long>(value));
+        value = value < prompt.minv ? prompt.minv : value > prompt.maxv ? prompt.maxv : value;
+        co_return true;
+    }
+
+    Task<bool> text(const Prompt& prompt, std::string& line) override {
+        line = bot.text(prompt);
+        co_return true;
+    }
+
+    Task<bool> pause(const Prompt&) override { co_return true; }
+
+private:
+    Bot bot;
+};
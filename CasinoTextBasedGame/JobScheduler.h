@@ -0,0 +1,241 @@
+﻿#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Trace.h"
+
+//================== Job Scheduler ==================//
+//------Work-stealing pool for the simulators and engines-------//
+// A loop over `count` items is cut into fixed chunks of `grain` items. The
+// chunk boundaries depend only on count and grain, never on the thread count,
+// and every chunk seeds its own generator from its index (Slice::seed), so a
+// simulation gives the same figures on one core or on sixty-four.
+//
+// Each participant owns a deque of chunk ranges. It takes a range from the
+// back of its own deque, halves it until one chunk is left, pushing the upper
+// halves back, and runs that chunk. An idle participant steals from the front
+// of someone else's deque, which is where the biggest ranges sit, so a worker
+// stuck on slow chunks (poker hands that reach the showdown) sheds the rest of
+// its range to workers whose chunks finished early (hands folded preflop).
+//
+// The calling thread takes part as participant 0; the pool adds threads - 1
+// workers, which sleep while there is nothing queued. Loops run one at a time:
+// a second caller waits its turn, and a loop started from inside a chunk runs
+// inline on that participant. Bodies must not throw.
+class JobScheduler {
+public:
+    // One chunk of a loop: items [begin, end), its index among the chunks and
+    // the participant running it (0..threads()-1, for per-thread scratch)
+    struct Slice {
+        uint64_t begin;
+        uint64_t end;
+        uint64_t index;
+        unsigned worker;
+
+        uint64_t size() const { return end - begin; }
+
+        // Seed for this chunk's generator: depends on `base` and the chunk index only
+        uint32_t seed(uint32_t base) const {
+            uint64_t z = (static_cast<uint64_t>(base) << 32 | base) + 0x9E3779B97F4A7C15ULL * (index + 1);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return static_cast<uint32_t>(z ^ (z >> 31));
+        }
+    };
+
+    explicit JobScheduler(unsigned threads = 0)
+        : count(threads ? threads : std::max(1u, std::thread::hardware_concurrency())), queues(new Queue[count]) {
+        for (unsigned i = 1; i < count; ++i) workers.emplace_back([this, i]() { work(i); });
+    }
+
+    ~JobScheduler() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        wakeup.notify_all();
+        for (auto& w : workers) w.join();
+    }
+
+    JobScheduler(const JobScheduler&) = delete;
+    JobScheduler& operator=(const JobScheduler&) = delete;
+
+    unsigned threads() const { return count; }
+
+    // Ranges taken from another participant's deque since the pool started
+    uint64_t steals() const { return stolen.load(std::memory_order_relaxed); }
+
+    static uint64_t chunks(uint64_t items, uint64_t grain) { return (items + std::max<uint64_t>(grain, 1) - 1) / std::max<uint64_t>(grain, 1); }
+
+    // Calls body(slice) once per chunk of 0..items and returns when all have run
+    template <typename Body>
+    void parallelFor(uint64_t items, uint64_t grain, const Body& body) {
+        grain = std::max<uint64_t>(grain, 1);
+        const uint64_t n = chunks(items, grain);
+        if (n == 0) return;
+        auto run = [&body, items, grain](uint64_t index, unsigned worker) {
+            TraceSpan span("chunk");
+            body(Slice{ index * grain, std::min(items, (index + 1) * grain), index, worker });
+        };
+
+        if (n == 1 || count == 1 || binding().pool == this) {
+            const unsigned self = binding().pool == this ? binding().slot : 0;
+            for (uint64_t i = 0; i < n; ++i) run(i, self);
+            return;
+        }
+
+        std::lock_guard<std::mutex> turn(callerMutex);
+        const Binding outer = binding();
+        binding() = Binding{ this, 0 };
+
+        Loop loop;
+        loop.body = &run;
+        loop.call = [](const void* f, uint64_t index, unsigned worker) { (*static_cast<const decltype(run)*>(f))(index, worker); };
+        loop.left.store(n, std::memory_order_relaxed);
+        push(0, Range{ &loop, 0, n });
+
+        // Help until every chunk has finished, including those running elsewhere
+        Range r;
+        while (loop.left.load(std::memory_order_acquire) != 0) {
+            if (take(0, r)) execute(r, 0);
+            else std::this_thread::yield();
+        }
+        binding() = outer;
+    }
+
+    // body(slice) returns a T for its chunk; the parts are folded into `init`
+    // with combine(T& into, const T& part) in chunk order, so floating-point
+    // totals do not depend on which thread finished first
+    template <typename T, typename Body, typename Combine>
+    T parallelReduce(uint64_t items, uint64_t grain, T init, const Body& body, const Combine& combine) {
+        std::vector<T> parts(static_cast<size_t>(chunks(items, grain)), init);
+        parallelFor(items, grain, [&](const Slice& s) { parts[static_cast<size_t>(s.index)] = body(s); });
+        for (const T& p : parts) combine(init, p);
+        return init;
+    }
+
+private:
+    struct Loop {
+        void (*call)(const void* body, uint64_t index, unsigned worker) = nullptr;
+        const void* body = nullptr;
+        std::atomic<uint64_t> left{ 0 };
+    };
+
+    // Chunk indices [begin, end) of one loop
+    struct Range {
+        Loop* loop = nullptr;
+        uint64_t begin = 0;
+        uint64_t end = 0;
+    };
+
+    // Held only for a push, a pop or a steal, never while a chunk runs
+    struct alignas(64) Queue {
+        std::mutex m;
+        std::deque<Range> ranges;
+    };
+
+    struct Binding {
+        const JobScheduler* pool = nullptr;
+        unsigned slot = 0;
+    };
+
+    const unsigned count;
+    std::unique_ptr<Queue[]> queues;
+    std::vector<std::thread> workers;
+    std::mutex callerMutex;
+    std::atomic<uint64_t> queued{ 0 };
+    std::atomic<uint64_t> stolen{ 0 };
+    std::atomic<unsigned> sleepers{ 0 };
+    std::mutex sleepMutex;
+    std::condition_variable wakeup;
+    bool stopping = false;
+
+    // Which pool and participant this thread is, while it is one
+    static Binding& binding() {
+        thread_local Binding b;
+        return b;
+    }
+
+    void push(unsigned self, const Range& r) {
+        {
+            std::lock_guard<std::mutex> lock(queues[self].m);
+            queues[self].ranges.push_back(r);
+        }
+        queued.fetch_add(1);
+        if (sleepers.load() != 0) {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            wakeup.notify_one();
+        }
+    }
+
+    // Newest range from our own deque, else the oldest from someone else's
+    bool take(unsigned self, Range& r) {
+        if (queued.load(std::memory_order_relaxed) == 0) return false;
+        {
+            Queue& q = queues[self];
+            std::lock_guard<std::mutex> lock(q.m);
+            if (!q.ranges.empty()) {
+                r = q.ranges.back();
+                q.ranges.pop_back();
+                queued.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        for (unsigned k = 1; k < count; ++k) {
+            Queue& q = queues[(self + k) % count];
+            std::lock_guard<std::mutex> lock(q.m);
+            if (q.ranges.empty()) continue;
+            r = q.ranges.front();
+            q.ranges.pop_front();
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            stolen.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    void execute(Range r, unsigned self) {
+        while (r.end - r.begin > 1) {
+            const uint64_t mid = r.begin + (r.end - r.begin) / 2;
+            push(self, Range{ r.loop, mid, r.end });
+            r.end = mid;
+        }
+        r.loop->call(r.loop->body, r.begin, self);
+        r.loop->left.fetch_sub(1, std::memory_order_release);
+    }
+
+    void work(unsigned self) {
+        binding() = Binding{ this, self };
+        Range r;
+        for (;;) {
+            // Spin briefly before sleeping: splits arrive in bursts
+            bool found = false;
+            for (int spin = 0; spin < 64 && !found; ++spin) {
+                found = take(self, r);
+                if (!found) std::this_thread::yield();
+            }
+            if (found) {
+                execute(r, self);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            sleepers.fetch_add(1);
+            wakeup.wait(lock, [this]() { return stopping || queued.load() != 0; });
+            sleepers.fetch_sub(1);
+            if (stopping) return;
+        }
+    }
+};
+
+// The simulators' pool, one participant per core unless `threads` says otherwise
+// on the first call; its workers start then and sleep between loops
+inline JobScheduler& jobScheduler(unsigned threads = 0) {
+    static JobScheduler pool(threads);
+    return pool;
+}
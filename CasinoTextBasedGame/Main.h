@@ -1,7 +1,9 @@
 ﻿#pragma once
 #include <algorithm>
+#include <array>
 #include <cctype>
 #include <chrono>
+#include <cstdlib>
 #include <ctime>
 #include <iostream>
 #include <limits>
@@ -9,9 +11,15 @@
 #include <random>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <utility>
 #include <vector>
+#include "Terminal.h"
+#include "InputSource.h"
+#include "EventLog.h"
+#include "Metrics.h"
+#include "Trace.h"
 
 #ifdef min
 #undef min
@@ -47,17 +55,13 @@ public:
 		return 0;
 	}
 
-	std::vector<std::string> displayCard() const {
-		std::vector<std::string> card(7);
-		card[0] = u8"┌─────────┐";
-		card[1] = u8"│" + rankToString() + u8"       │";
-		card[2] = u8"│         │";
-		card[3] = u8"│    " + suitToString() + u8"    │";
-		card[4] = u8"│         │";
-		card[5] = u8"│       " + rankToString() + u8"│";
-		card[6] = u8"└─────────┘";
-		return card;
-	}
+	// Card art is 7 rows of 11 columns; rows come from the atlas, so drawing copies nothing
+	static constexpr int artRows = 7;
+	std::string_view artRow(int line) const { return atlas()[atlasIndex()][line]; }
+	static std::string_view backRow(int line) { return atlas()[52][line]; }
+
+	// 0-51, suit-major: the atlas slot, and the card's code in the event log
+	int atlasIndex() const { return suit * 13 + (rank - Two); }
 private:
 	// Return a 2-char rank string for aligning the card art:
 	// "10" for Ten, otherwise single char plus a trailing space (e.g. "A ", "K ", "2 ")
@@ -90,61 +94,86 @@ private:
 		default:       return u8" ";
 		}
 	}
-public:
-	static std::vector<std::string> hiddenCard() {
-		std::vector<std::string> card(7);
-		card[0] = u8"┌─────────┐";
-		card[1] = u8"│░░░░░░░░░│";
-		card[2] = u8"│░░░░░░░░░│";
-		card[3] = u8"│░░░░░░░░░│";
-		card[4] = u8"│░░░░░░░░░│";
-		card[5] = u8"│░░░░░░░░░│";
-		card[6] = u8"└─────────┘";
-		return card;
+
+	using Art = std::array<std::string, artRows>;
+
+	// All 52 faces plus the back (slot 52), built once on first use
+	static const std::array<Art, 53>& atlas() {
+		static const std::array<Art, 53> art = [] {
+			std::array<Art, 53> a;
+			for (int s = Hearts; s <= Spades; ++s) {
+				for (int r = Two; r <= Ace; ++r) {
+					const Card c(static_cast<Rank>(r), static_cast<Suit>(s));
+					Art& card = a[c.atlasIndex()];
+					card[0] = u8"┌─────────┐";
+					card[1] = u8"│" + c.rankToString() + u8"       │";
+					card[2] = u8"│         │";
+					card[3] = u8"│    " + c.suitToString() + u8"    │";
+					card[4] = u8"│         │";
+					card[5] = u8"│       " + c.rankToString() + u8"│";
+					card[6] = u8"└─────────┘";
+				}
+			}
+			Art& back = a[52];
+			back[0] = u8"┌─────────┐";
+			for (int line = 1; line < 6; ++line) back[line] = u8"│░░░░░░░░░│";
+			back[6] = u8"└─────────┘";
+			return a;
+		}();
+		return art;
 	}
 };
 
+//================== Random Helpers ==================//
+// Every deal and roll goes through here; a server session has its own generator
+static std::mt19937& rng() {
+	if (std::mt19937* session = sessionContext().rng) return *session;
+	static std::mt19937 g((unsigned)std::chrono::high_resolution_clock::now().time_since_epoch().count());
+	return g;
+}
+int randint(int lo, int hi) { std::uniform_int_distribution<int> d(lo, hi); return d(rng()); }
+
 //================== Deck Definition ==================//
 //------Deck class representing a deck of cards-------//
 class Deck {
 public:
-	Deck() { refill(); shuffle(); }
+	explicit Deck(int numDecks = 1) : decks(numDecks < 1 ? 1 : numDecks) { refill(); shuffle(); }
 
-	// Build a standard 52-card deck
+	// Build a shoe of `decks` standard 52-card decks
 	void refill() {
 		cards.clear();
-		for (int s = Card::Hearts; s <= Card::Spades; ++s) {
-			for (int r = Card::Two; r <= Card::Ace; ++r) {
-				cards.emplace_back(static_cast<Card::Rank>(r), static_cast<Card::Suit>(s));
+		cards.reserve(static_cast<size_t>(decks) * 52);
+		for (int d = 0; d < decks; ++d) {
+			for (int s = Card::Hearts; s <= Card::Spades; ++s) {
+				for (int r = Card::Two; r <= Card::Ace; ++r) {
+					cards.emplace_back(static_cast<Card::Rank>(r), static_cast<Card::Suit>(s));
+				}
 			}
 		}
 		idx = 0;
 	}
 
 	void shuffle() {
-		std::random_shuffle(cards.begin(), cards.end());
+		std::shuffle(cards.begin(), cards.end(), rng());
 		idx = 0;
 	}
 
+	int deckCount() const { return decks; }
+	size_t size() const { return cards.size(); }
+
 	size_t remaining() const { return (idx <= cards.size()) ? cards.size() - idx : 0; }
 
 	// Deal the next card (wraps by refilling & shuffling if exhausted)
 	Card dealCard() {
+		PhaseTimer timing(Phase::Deal);
+		countMetric(Counter::CardsDealt);
 		if (idx >= cards.size()) {
 			refill();
 			shuffle();
 		}
+		recordEvent(EventType::CardDealt, static_cast<uint8_t>(cards[idx].atlasIndex()));
 		return cards[idx++];
 	}
-<<<<<<< Updated upstream
-<<<<<<< Updated upstream
-	template<typename Pred>
-	Crad findAndRemove(Pred p) {
-		for 
-	}
-=======
-=======
->>>>>>> Stashed changes
 
 	// Search for a card matching predicate among the remaining cards and remove it.
 	// If none found, returns dealCard() as fallback.
@@ -152,8 +181,11 @@ public:
 	Card findAndRemove(Pred p) {
 		for (size_t i = idx; i < cards.size(); ++i) {
 			if (p(cards[i])) {
+				PhaseTimer timing(Phase::Deal);
+				countMetric(Counter::CardsDealt);
 				Card found = cards[i];
 				cards.erase(cards.begin() + i);
+				recordEvent(EventType::CardDealt, static_cast<uint8_t>(found.atlasIndex()));
 				return found;
 			}
 		}
@@ -161,6 +193,12 @@ public:
 		return dealCard();
 	}
 
+	// Visit every undealt card (composition-based odds and hints)
+	template<typename Fn>
+	void forEachRemaining(Fn fn) const {
+		for (size_t i = idx; i < cards.size(); ++i) fn(cards[i]);
+	}
+
 	// Replace at absolute index (careful - mostly unused)
 	void replaceAt(size_t position, const Card& c) {
 		if (position < cards.size()) cards[position] = c;
@@ -168,47 +206,34 @@ public:
 private:
 	std::vector<Card> cards;
 	size_t idx = 0;
-<<<<<<< Updated upstream
->>>>>>> Stashed changes
-=======
->>>>>>> Stashed changes
+	int decks = 1;
 };
 
 //================== Utility Functions ==================//
 //------Function to draw an ASCII box around text-------//
-static size_t utf8_codepoints(const std::string& s) {
+static size_t utf8_codepoints(std::string_view s) {
 	size_t count = 0;
 	for (unsigned char c : s) {
 		if ((c & 0xC0) != 0x80) ++count; // count only lead bytes
 	}
 	return count;
 }
-void drawAsciiBox(const std::string& text, int padding = 2) {
-	std::vector<std::string> lines;
-	std::stringstream ss(text);
-	std::string line;
-	size_t maxVisual = 0;
 
-	// Split text into lines & find longest (visually)
-	while (std::getline(ss, line)) {
-		lines.push_back(line);
-		maxVisual = std::max(maxVisual, utf8_codepoints(line));
-	}
-
-	if (lines.empty()) {
-		lines.push_back("");
-		maxVisual = 0;
+// Composes the box into `out`; nothing is written until the frame is presented
+void drawAsciiBox(FrameBuffer& out, std::string_view text, int padding = 2) {
+	// Longest line (visually); a trailing newline does not start another line
+	size_t maxVisual = 0;
+	for (size_t pos = 0; pos < text.size();) {
+		size_t end = text.find('\n', pos);
+		if (end == std::string_view::npos) end = text.size();
+		maxVisual = std::max(maxVisual, utf8_codepoints(text.substr(pos, end - pos)));
+		pos = end + 1;
 	}
 
 	// Total inner width = content + (left/right padding)
 	const size_t innerWidth = maxVisual + padding * 2;
 
-	// Draw top border
-	std::cout << u8"╔";
-	for (size_t i = 0; i < innerWidth; ++i) std::cout << u8"═";
-	std::cout << u8"╗\n";
-
-	for (const auto& l : lines) {
+	auto row = [&](std::string_view l) {
 		size_t visual = utf8_codepoints(l);
 		// Total remaining space after accounting for padding
 		size_t remaining = (innerWidth > visual) ? innerWidth - visual : 0;
@@ -217,141 +242,50 @@ void drawAsciiBox(const std::string& text, int padding = 2) {
 		size_t leftPad = remaining / 2;
 		size_t rightPad = remaining - leftPad;
 
-		std::cout << u8"║"
-			<< std::string(leftPad, ' ')
-			<< l
-			<< std::string(rightPad, ' ')
-			<< u8"║\n";
+		out << u8"║";
+		out.spaces(leftPad) << l;
+		out.spaces(rightPad) << u8"║\n";
+	};
+
+	// Draw top border
+	out << u8"╔";
+	out.repeat(u8"═", innerWidth) << u8"╗\n";
+
+	if (text.empty()) row("");
+	for (size_t pos = 0; pos < text.size();) {
+		size_t end = text.find('\n', pos);
+		if (end == std::string_view::npos) end = text.size();
+		row(text.substr(pos, end - pos));
+		pos = end + 1;
 	}
 
 	// Draw bottom border
-	std::cout << u8"╚";
-	for (size_t i = 0; i < innerWidth; ++i) std::cout << u8"═";
-	std::cout << u8"╝\n";
+	out << u8"╚";
+	out.repeat(u8"═", innerWidth) << u8"╝\n";
 }
 
-<<<<<<< Updated upstream
-<<<<<<< Updated upstream
-//================== Player Definition ==================//
-//-----Player Class-----//
-=======
-=======
->>>>>>> Stashed changes
-static std::mt19937& rng() {
-	static std::mt19937 g((unsigned)std::chrono::high_resolution_clock::now().time_since_epoch().count());
-	return g;
-}
-int randint(int lo, int hi) { std::uniform_int_distribution<int> d(lo, hi); return d(rng()); }
-double readDouble(const std::string& prompt, double minv, double maxv) {
-	while (true) {
-		std::cout << prompt;
-		double x;
-		if (!(std::cin >> x)) {
-			std::cin.clear();
-			std::cin.ignore(10000, '\n');
-			std::cout << "Invalid input. Enter a number.\n";
-			continue;
-		}
-		std::cin.ignore(10000, '\n');
-		if (x < minv || x > maxv) {
-			std::cout << "Enter a number between " << minv << " and " << maxv << ".\n";
-			continue;
-		}
-		return x;
-	}
+void drawAsciiBox(const std::string& text, int padding = 2) {
+	drawAsciiBox(frame(), text, padding);
+	frame().present();
 }
-int readInt(const std::string& prompt, int minv, int maxv) {
-	while (true) {
-		std::cout << prompt;
-		int x;
-		if (!(std::cin >> x)) {
-			std::cin.clear();
-			std::cin.ignore(10000, '\n');
-			std::cout << "Invalid input. Enter an integer.\n";
-			continue;
-		}
-		std::cin.ignore(10000, '\n');
-		if (x < minv || x > maxv) {
-			std::cout << "Enter a number between " << minv << " and " << maxv << ".\n";
-			continue;
+
+//------Cards laid side by side, one art row per line-------//
+void drawCardRow(FrameBuffer& out, const std::vector<Card>& cards, bool hideFirst = false) {
+	if (cards.empty()) return;
+	for (int line = 0; line < Card::artRows; ++line) {
+		for (size_t i = 0; i < cards.size(); ++i) {
+			out << (i == 0 && hideFirst ? Card::backRow(line) : cards[i].artRow(line)) << ' ';
 		}
-		return x;
+		out << '\n';
 	}
 }
-void pauseEnter(const std::string& msg = "Press Enter to continue...") {
-	std::cout << msg;
-	std::string tmp;
-	std::getline(std::cin, tmp);
-}
-std::string readLineTrimmed(const std::string& prompt = "") {
-	if (!prompt.empty()) std::cout << prompt;
-	std::string line;
-	std::getline(std::cin, line);
-	// trim
-	auto l = line.find_first_not_of(" \t\r\n");
-	if (l == std::string::npos) return "";
-	auto r = line.find_last_not_of(" \t\r\n");
-	return line.substr(l, r - l + 1);
-}
 
 //================== Player Definition ==================//
 //------Class defining player attributes-------//
-<<<<<<< Updated upstream
->>>>>>> Stashed changes
-=======
->>>>>>> Stashed changes
 struct ActiveCurse {
 	std::string name;
 	int remainingRounds;
 };
-<<<<<<< Updated upstream
-<<<<<<< Updated upstream
-
-class Player {
-private:
-	std::string name;
-	double balance = 500.0;
-	double currentBet = 0.0;
-	int mana;
-	const int maxMana;
-	std::vector<ActiveCurse> curses;
-
-public: 
-	Player(std::string nm = "Player", double startBalance = 500.0) : name(std::move(nm)), balance(startBalance), mana(50), maxMana(100) {}
-
-	std::string getName() const {
-		return name;
-	}
-	double getBalance() const {
-		return balance;
-	}
-	int getMana() const {
-		return mana;
-	}
-
-	//betting
-	bool placeBet(double amount) {
-		if (amount <= 0 || amount > balance) {
-			drawAsciiBox("Invalid bet or Insufficient balance.");
-			return false;
-		}
-		balance -= amount;
-		currentBet = amount;
-		return true;
-	}
-	void payWin(double multiplier = 2.0) {
-		balance += static_cast<double>(currentBet) * multiplier; 
-		currentBet = 0;
-	}
-	void refundBet() {
-		balance += currentBet;
-		currentBet = 0;
-	}
-
-	//mana & blessing
-=======
-=======
->>>>>>> Stashed changes
 class Player {
 public:
 	Player(std::string nm = "Player", double startBalance = 500.0)
@@ -374,11 +308,13 @@ public:
 			balance = 0.0;
 			currentBet += amount;
 			isAllIn = true;
+			recordEvent(EventType::BetPlaced, 0, 0, toEventMicros(amount));
 			return true;
 		}
 		// normal deduct
 		balance -= amount;
 		currentBet += amount;
+		recordEvent(EventType::BetPlaced, 0, 0, toEventMicros(amount));
 		return true;
 	}
 
@@ -393,6 +329,7 @@ public:
 
 	// Refund only this player's current bet (used in some push logic)
 	void refundCurrentBet() {
+		recordEvent(EventType::Refund, 0, 0, toEventMicros(currentBet));
 		balance += currentBet;
 		currentBet = 0.0;
 		isAllIn = false;
@@ -419,10 +356,6 @@ public:
 	}
 
 	// Mana & Blessings (unchanged semantics)
-<<<<<<< Updated upstream
->>>>>>> Stashed changes
-=======
->>>>>>> Stashed changes
 	bool useMana(int cost) {
 		if (mana < cost) return false;
 		mana -= cost;
@@ -432,123 +365,60 @@ public:
 		mana += amount;
 		if (mana > maxMana) mana = maxMana;
 	}
-<<<<<<< Updated upstream
-<<<<<<< Updated upstream
-	void castBlessing(const std::string& b) {
-		if (b == "Fate's Glimpse") {
-			if (useMana(15)) {
-				fateGlimpse = true;
-				drawAsciiBox("Fate's Glimpse active for this round.");
-			}
-			else drawAsciiBox("Not enough mana for Fate's Glimpse.");
-		}
-		else if (b == "Lucky Draw") {
-			if (useMana(20)) {
-				luckyDraw = true;
-				drawAsciiBox("Lucky Draw active: next card you draw will be 10-valued.");
-			}
-			else drawAsciiBox("Not enough mana for Lucky Draw.");
-		}
-		else if (b == "Mana Shield") {
-			if (useMana(10)) {
-				manaShield = true;
-				drawAsciiBox("Mana Shield Active: Will block one new curse this round.");
-			}
-			else drawAsciiBox("Not enough mana for Mana Shield.");
-		}
-		else {
-			drawAsciiBox("Unknown Blessing.");
-		}
-	}
-=======
-=======
->>>>>>> Stashed changes
 
-	void castBlessing(const std::string& b) {
+	// Returns true if the blessing is now active; announce=false skips the boxes
+	bool castBlessing(const std::string& b, bool announce = true) {
+		const char* message = "Unknown blessing.";
+		bool cast = false;
 		if (b == "Fate's Glimpse") {
-			if (useMana(15)) { fateGlimpse = true; drawAsciiBox("Fate's Glimpse active for this round."); }
-			else drawAsciiBox("Not enough mana for Fate's Glimpse.");
+			cast = useMana(15);
+			if (cast) fateGlimpse = true;
+			message = cast ? "Fate's Glimpse active for this round." : "Not enough mana for Fate's Glimpse.";
 		}
 		else if (b == "Lucky Draw") {
-			if (useMana(20)) { luckyDraw = true; drawAsciiBox("Lucky Draw active: next card for you will be 10-valued."); }
-			else drawAsciiBox("Not enough mana for Lucky Draw.");
+			cast = useMana(20);
+			if (cast) luckyDraw = true;
+			message = cast ? "Lucky Draw active: next card for you will be 10-valued." : "Not enough mana for Lucky Draw.";
 		}
 		else if (b == "Mana Shield") {
-			if (useMana(10)) { manaShield = true; drawAsciiBox("Mana Shield active: will block one new curse this round."); }
-			else drawAsciiBox("Not enough mana for Mana Shield.");
-		}
-		else {
-			drawAsciiBox("Unknown blessing.");
+			cast = useMana(10);
+			if (cast) manaShield = true;
+			message = cast ? "Mana Shield active: will block one new curse this round." : "Not enough mana for Mana Shield.";
 		}
+		if (cast) recordEvent(EventType::BlessingCast, b == "Fate's Glimpse" ? FatesGlimpse : b == "Lucky Draw" ? LuckyDraw : ManaShield);
+		if (announce) drawAsciiBox(message);
+		return cast;
 	}
 
-<<<<<<< Updated upstream
->>>>>>> Stashed changes
-=======
->>>>>>> Stashed changes
 	void clearBlessings() {
 		luckyDraw = false;
 		fateGlimpse = false;
 		manaShield = false;
 	}
 
-<<<<<<< Updated upstream
-<<<<<<< Updated upstream
-	//curses : stored by name and remaining rounds
-	void applyCurse(const std::string& curseName, int duration) {
-		if (manaShield) {
-			manaShield = false;
-			drawAsciiBox("Mana Shield absorde the curse:" + curseName);
-=======
-=======
->>>>>>> Stashed changes
 	// Curses: store by name + remaining rounds
-	void applyCurse(const std::string& curseName, int duration) {
+	// Returns true if a new curse landed (not absorbed or refreshed); announce=false skips the boxes
+	bool applyCurse(const std::string& curseName, int duration, bool announce = true) {
+		const uint8_t curseId = curseName == "Muddled Sight" ? MuddledSight : curseName == "Unlucky Hand" ? UnluckyHand : OtherCurse;
 		if (manaShield) {
 			// negate one curse application
 			manaShield = false;
-			drawAsciiBox("Mana Shield absorbed the curse: " + curseName);
-<<<<<<< Updated upstream
->>>>>>> Stashed changes
-=======
->>>>>>> Stashed changes
-			return;
+			recordEvent(EventType::CurseApplied, curseId, 2);
+			if (announce) drawAsciiBox("Mana Shield absorbed the curse: " + curseName);
+			return false;
 		}
 		for (auto& c : curses) {
 			if (c.name == curseName) {
-<<<<<<< Updated upstream
-<<<<<<< Updated upstream
-				c.remainingRounds = duration;
-				drawAsciiBox("Curse Refreshed: " + curseName);
-=======
-				c.remainingRounds = duration; // refresh
-				drawAsciiBox("Curse refreshed: " + curseName);
->>>>>>> Stashed changes
-=======
 				c.remainingRounds = duration; // refresh
-				drawAsciiBox("Curse refreshed: " + curseName);
->>>>>>> Stashed changes
-				return;
+				recordEvent(EventType::CurseApplied, curseId, 1);
+				if (announce) drawAsciiBox("Curse refreshed: " + curseName);
+				return false;
 			}
 		}
 		curses.push_back({ curseName, duration });
-<<<<<<< Updated upstream
-<<<<<<< Updated upstream
-		drawAsciiBox("You recieved a curse: " + curseName + " for (" + std::to_string(duration) + " rounds)");
-	}
-	bool hasCurse(const std::string& curseName) const {
-		for (auto& c : curses) {
-			if (c.name == curseName && c.remainingRounds > 0) {
-				return true;
-			}
-		}
-		return false;
-	}
-	void decayCurse() {
-=======
-=======
->>>>>>> Stashed changes
-		drawAsciiBox("You received a curse: " + curseName + " (" + std::to_string(duration) + " rounds)");
+		recordEvent(EventType::CurseApplied, curseId, 0);
+		if (announce) drawAsciiBox("You received a curse: " + curseName + " (" + std::to_string(duration) + " rounds)");
+		return true;
 	}
 
 	bool hasCurse(const std::string& curseName) const {
@@ -557,15 +427,11 @@ public:
 	}
 
 	// Decrement curse durations after each round
-	void decayCurses() {
-<<<<<<< Updated upstream
->>>>>>> Stashed changes
-=======
->>>>>>> Stashed changes
+	void decayCurses(bool announce = true) {
 		for (auto it = curses.begin(); it != curses.end();) {
 			it->remainingRounds--;
 			if (it->remainingRounds <= 0) {
-				drawAsciiBox("Curse ended: " + it->name);
+				if (announce) drawAsciiBox("Curse ended: " + it->name);
 				it = curses.erase(it);
 			}
 			else ++it;
@@ -573,67 +439,43 @@ public:
 	}
 
 	void showStatus() const {
-		std::ostringstream oss;
-		oss << "PLAYER STATUS\n";
-		oss << "Name: " << name << "\n";
-<<<<<<< Updated upstream
-<<<<<<< Updated upstream
-		oss << "Balance: £" << balance << "\n";
-		oss << "Mana: " << mana << "/" << maxMana << "\n";
-		if (!curses.empty()) {
-			oss << "Curses:\n";
-			for (auto& c : curses) {
-				oss << " - " << c.name << " (" << c.remainingRounds << ")\n";
-			}
-		}
-		else oss << "Curses: No active curses.\n";
-		oss << "Blessings active:\n";
-		if (luckyDraw) {
-			oss << " - Lucky Draw\n";
-		}
-		if (fateGlimpse) {
-			oss << " - Fate Glimpse\n";
-		}
-		if (manaShield) {
-			oss << " - Mana Shield\n";
-		}
-		if (!luckyDraw && !fateGlimpse && !manaShield) {
-			oss << " - None active";
-			drawAsciiBox(oss.str());
-		}
-	}
-
-	bool luckyDraw = false; // force next card to be valued 10
-	bool fateGlimpse = false; // reavel hidden card/opponent hand
-	bool manaShield = false; // block one curse in a round
-};
-
-//================== Helper Functions ==================//
-//-----Game Helpers for blessings/curses-----//
-
-Card drawCardForPlayer(Deck& deck, Player& player) {
-	if (player.luckyDraw) {
-		Card found = deck.findAndRemove([] const Card & c) {
-			int v = (int)c.rank();
-		}
-	}
-=======
-=======
->>>>>>> Stashed changes
-		oss << u8"Balance: £" << balance << "\n";
-		oss << u8"Current Bet: £" << currentBet << "\n";
-		oss << "Mana: " << mana << "/" << maxMana << "\n";
+		showStatus(frame());
+		frame().present();
+	}
+
+	void showStatus(FrameBuffer& out) const {
+		thread_local FrameBuffer text; // box contents; reused so a redraw allocates nothing
+		text.clear();
+		text << "PLAYER STATUS\n";
+		text << "Name: " << name << "\n";
+		text << u8"Balance: £" << balance << "\n";
+		text << u8"Current Bet: £" << currentBet << "\n";
+		text << "Mana: " << mana << "/" << maxMana << "\n";
 		if (!curses.empty()) {
-			oss << "Curses:\n";
-			for (auto& c : curses) oss << " - " << c.name << " (" << c.remainingRounds << ")\n";
-		}
-		else oss << "Curses: None\n";
-		oss << "Blessings active:\n";
-		if (luckyDraw) oss << " - Lucky Draw\n";
-		if (fateGlimpse) oss << " - Fate's Glimpse\n";
-		if (manaShield) oss << " - Mana Shield\n";
-		if (!luckyDraw && !fateGlimpse && !manaShield) oss << " - None\n";
-		drawAsciiBox(oss.str());
+			text << "Curses:\n";
+			for (auto& c : curses) text << " - " << c.name << " (" << c.remainingRounds << ")\n";
+		}
+		else text << "Curses: None\n";
+		text << "Blessings active:\n";
+		if (luckyDraw) text << " - Lucky Draw\n";
+		if (fateGlimpse) text << " - Fate's Glimpse\n";
+		if (manaShield) text << " - Mana Shield\n";
+		if (!luckyDraw && !fateGlimpse && !manaShield) text << " - None\n";
+		drawAsciiBox(out, text.view());
+	}
+
+	// ----- Saved profiles -----
+	int getMaxMana() const { return maxMana; }
+	const std::vector<ActiveCurse>& getCurses() const { return curses; }
+
+	// Puts back a saved profile's balance, mana and curses; mana is clamped to the cap
+	void restore(double savedBalance, int savedMana, std::vector<ActiveCurse> savedCurses) {
+		balance = savedBalance;
+		mana = std::clamp(savedMana, 0, maxMana);
+		curses = std::move(savedCurses);
+		currentBet = 0.0;
+		isFolded = false;
+		isAllIn = false;
 	}
 
 	// public fields for easy checks (temporary flags)
@@ -655,32 +497,45 @@ private:
 class CasinoManager {
 public:
 	Player& player;
+	InputSource& input; // every prompt of the session, from the menu down to each game
 	double totalEarnings = 0;
 	double totalLosses = 0;
 
-	CasinoManager(Player& p) : player(p) {}
+	CasinoManager(Player& p, InputSource& in = consoleInput()) : player(p), input(in) {}
 
-	bool placeBet(double& betAmount, double min = 10, double max = 1000) {
-		betAmount = readDouble(u8"Enter your bet (£" + std::to_string(min) + u8"–£" + std::to_string(max) + "): ", min, max);
+	// Asks for a stake and takes it; yields false if the balance cannot cover it
+	Task<bool> placeBet(double& betAmount, double min = 10, double max = 1000, bool announce = true) {
+		betAmount = co_await input.readDouble(u8"Enter your bet (£" + std::to_string(min) + u8"–£" + std::to_string(max) + "): ", min, max);
 		if (player.getBalance() < betAmount) {
-			drawAsciiBox(u8"Insufficient funds. Your balance: £" + std::to_string(player.getBalance()));
-			return false;
+			if (announce) drawAsciiBox(u8"Insufficient funds. Your balance: £" + std::to_string(player.getBalance()));
+			co_return false;
 		}
 		player.placeBet(betAmount);
-		drawAsciiBox(u8"Bet placed: £" + std::to_string(betAmount) + u8"\nRemaining balance: £" + std::to_string(player.getBalance()));
-		return true;
+		if (announce) drawAsciiBox(u8"Bet placed: £" + std::to_string(betAmount) + u8"\nRemaining balance: £" + std::to_string(player.getBalance()));
+		co_return true;
 	}
 
-	void processWin(double betAmount, double multiplier = 2.0) {
+	// announce=false settles without drawing, for batched play that reports once at the end
+	void processWin(double betAmount, double multiplier = 2.0, bool announce = true) {
 		double win = betAmount * multiplier;
-		player.payWin(win);
-		totalEarnings += (win - betAmount);
-		drawAsciiBox(u8"You won £" + std::to_string(win) + u8"!\nNew balance: £" + std::to_string(player.getBalance()));
+		{
+			PhaseTimer timing(Phase::Settle);
+			recordEvent(EventType::Payout, 0, 0, toEventMicros(win));
+			player.payWin(win);
+			player.clearCurrentBet(); // settled: a later push must not refund it
+			totalEarnings += (win - betAmount);
+		}
+		if (announce) drawAsciiBox(u8"You won £" + std::to_string(win) + u8"!\nNew balance: £" + std::to_string(player.getBalance()));
 	}
 
-	void processLoss(double betAmount) {
-		totalLosses += betAmount;
-		drawAsciiBox(u8"You lost £" + std::to_string(betAmount) + u8"\nBalance: £" + std::to_string(player.getBalance()));
+	void processLoss(double betAmount, bool announce = true) {
+		{
+			PhaseTimer timing(Phase::Settle);
+			recordEvent(EventType::Loss, 0, 0, toEventMicros(betAmount));
+			player.clearCurrentBet();
+			totalLosses += betAmount;
+		}
+		if (announce) drawAsciiBox(u8"You lost £" + std::to_string(betAmount) + u8"\nBalance: £" + std::to_string(player.getBalance()));
 	}
 
 	void showStats() {
@@ -734,22 +589,19 @@ bool maybeFlipHSChoiceIfMuddled(Player& player, bool originalChoiceStand) {
 	return originalChoiceStand;
 }
 
-// Chance to apply a random curse after a loss
-void maybeApplyRandomCurseAfterLoss(Player& player) {
+// Chance to apply a random curse after a loss; returns true if a new curse landed
+bool maybeApplyRandomCurseAfterLoss(Player& player, bool announce = true) {
 	int roll = randint(1, 100);
 	if (roll <= 25) { // 25% chance to get a curse
 		int pick = randint(1, 2);
-		if (pick == 1) const_cast<Player&>(player).applyCurse("Muddled Sight", 2);
-		else const_cast<Player&>(player).applyCurse("Unlucky Hand", 3);
+		if (pick == 1) return player.applyCurse("Muddled Sight", 2, announce);
+		else return player.applyCurse("Unlucky Hand", 3, announce);
 	}
+	return false;
 }
 
 // Show round summary: balance, mana, active curses
 void showRoundSummary(const Player& player) {
 	// player.showStatus already composes and draws a boxed status
 	player.showStatus();
-<<<<<<< Updated upstream
->>>>>>> Stashed changes
-=======
->>>>>>> Stashed changes
 }
\ No newline at end of file
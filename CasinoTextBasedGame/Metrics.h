@@ -0,0 +1,302 @@
+﻿#pragma once
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CASINO_METRICS_TSC
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+//================== Metrics ==================//
+//------What is measured-------//
+// Latency of the phases of a round, and counts of the hot-path operations.
+// Every thread records into its own shard with plain stores (no lock, no
+// read-modify-write), and a read sums the shards. A sample is two timestamp
+// reads and a bucket increment, a few nanoseconds, so recording is always on.
+enum class Phase : uint8_t {
+    Deal,     // one card off a deck or shoe, reshuffles included
+    Decide,   // a prompt answered by the player, a script or a bot
+    Evaluate, // scoring a hand, a coup or a spin
+    Settle,   // paying out or booking a loss
+    Render,   // a finished frame handed to the terminal or socket
+};
+constexpr int phaseCount = 5;
+
+enum class Counter : uint8_t { CardsDealt, EvaluatorCalls, Allocations };
+constexpr int counterCount = 3;
+
+inline const char* phaseName(Phase p) {
+    static const char* names[phaseCount] = { "deal", "decide", "evaluate", "settle", "render" };
+    return names[static_cast<int>(p)];
+}
+
+inline const char* counterName(Counter c) {
+    static const char* names[counterCount] = { "Cards dealt", "Evaluator calls", "Allocations" };
+    return names[static_cast<int>(c)];
+}
+
+//------Clock-------//
+// The time-stamp counter where there is one (a handful of cycles to read),
+// otherwise steady_clock. Samples stay in ticks; reads convert to nanoseconds.
+inline uint64_t metricTicks() {
+#ifdef CASINO_METRICS_TSC
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+//------Latency histogram-------//
+// HDR-style log-linear buckets: values below 16 ticks get a bucket each, and
+// every power of two above is split into 16 sub-buckets, so any recorded
+// value is known to within 1/16 (about 6%). 720 buckets reach 2^48 ticks,
+// many hours at any clock rate; longer samples land in the last bucket.
+// Written by one thread only; atomics make concurrent reads well defined.
+class LatencyHistogram {
+public:
+    static constexpr int subBits = 4;
+    static constexpr int subBuckets = 1 << subBits;
+    static constexpr int topExponent = 47;
+    static constexpr int bucketCount = (topExponent - subBits + 2) * subBuckets;
+
+    void record(uint64_t ticks) {
+        bump(buckets[bucketOf(ticks)], 1);
+        bump(total, 1);
+        bump(sum, ticks);
+        if (ticks > peak.load(std::memory_order_relaxed)) peak.store(ticks, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+
+    static int bucketOf(uint64_t v) {
+        if (v < static_cast<uint64_t>(subBuckets)) return static_cast<int>(v);
+        const int e = static_cast<int>(std::bit_width(v)) - 1;
+        if (e > topExponent) return bucketCount - 1;
+        return (e - subBits + 1) * subBuckets + static_cast<int>((v >> (e - subBits)) & (subBuckets - 1));
+    }
+
+    // Highest value that lands in bucket i
+    static uint64_t bucketTop(int i) {
+        if (i < subBuckets) return static_cast<uint64_t>(i);
+        const int e = i / subBuckets + subBits - 1;
+        const uint64_t low = static_cast<uint64_t>(subBuckets + i % subBuckets) << (e - subBits);
+        return low + (uint64_t(1) << (e - subBits)) - 1;
+    }
+
+private:
+    friend struct MetricsSnapshot;
+    std::atomic<uint64_t> buckets[bucketCount] = {};
+    std::atomic<uint64_t> total{ 0 };
+    std::atomic<uint64_t> sum{ 0 };
+    std::atomic<uint64_t> peak{ 0 };
+
+    static void bump(std::atomic<uint64_t>& a, uint64_t n) { a.store(a.load(std::memory_order_relaxed) + n, std::memory_order_relaxed); }
+};
+
+//------One thread's samples-------//
+struct MetricsShard {
+    LatencyHistogram phases[phaseCount];
+    std::atomic<uint64_t> counters[counterCount] = {};
+
+    void count(Counter c, uint64_t n) {
+        std::atomic<uint64_t>& a = counters[static_cast<int>(c)];
+        a.store(a.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+};
+
+//------Merged view-------//
+struct MetricsSnapshot {
+    struct PhaseStats {
+        uint64_t count = 0;
+        uint64_t sumTicks = 0;
+        uint64_t maxTicks = 0;
+        std::vector<uint64_t> buckets = std::vector<uint64_t>(LatencyHistogram::bucketCount, 0);
+
+        // Upper bound of the bucket holding quantile q, in ticks
+        uint64_t quantileTicks(double q) const {
+            if (count == 0) return 0;
+            const uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(count - 1)) + 1;
+            uint64_t seen = 0;
+            for (int i = 0; i < LatencyHistogram::bucketCount; ++i) {
+                seen += buckets[i];
+                if (seen >= rank) return std::min(LatencyHistogram::bucketTop(i), maxTicks);
+            }
+            return maxTicks;
+        }
+    };
+
+    PhaseStats phases[phaseCount];
+    uint64_t counters[counterCount] = {};
+    double nanosPerTick = 1.0;
+    unsigned threads = 0;
+
+    void add(const MetricsShard& s) {
+        for (int p = 0; p < phaseCount; ++p) {
+            const LatencyHistogram& h = s.phases[p];
+            PhaseStats& out = phases[p];
+            out.count += h.total.load(std::memory_order_relaxed);
+            out.sumTicks += h.sum.load(std::memory_order_relaxed);
+            out.maxTicks = std::max(out.maxTicks, h.peak.load(std::memory_order_relaxed));
+            for (int i = 0; i < LatencyHistogram::bucketCount; ++i) out.buckets[i] += h.buckets[i].load(std::memory_order_relaxed);
+        }
+        for (int c = 0; c < counterCount; ++c) counters[c] += s.counters[c].load(std::memory_order_relaxed);
+    }
+
+    // The table shown by the metrics dump
+    std::string describe() const {
+        std::string out = "METRICS (" + std::to_string(threads) + " recording thread" + (threads == 1 ? "" : "s") + ")\n\n";
+        char line[160];
+        std::snprintf(line, sizeof line, "%-9s %10s %9s %9s %9s %9s %9s %9s\n", "phase", "samples", "mean", "p50", "p90", "p99", "p99.9", "max");
+        out += line;
+        for (int p = 0; p < phaseCount; ++p) {
+            const PhaseStats& s = phases[p];
+            const double mean = s.count ? static_cast<double>(s.sumTicks) / s.count : 0.0;
+            std::snprintf(line, sizeof line, "%-9s %10llu %9s %9s %9s %9s %9s %9s\n", phaseName(static_cast<Phase>(p)),
+                static_cast<unsigned long long>(s.count), duration(mean).c_str(),
+                duration(static_cast<double>(s.quantileTicks(0.5))).c_str(), duration(static_cast<double>(s.quantileTicks(0.9))).c_str(),
+                duration(static_cast<double>(s.quantileTicks(0.99))).c_str(), duration(static_cast<double>(s.quantileTicks(0.999))).c_str(),
+                duration(static_cast<double>(s.maxTicks)).c_str());
+            out += line;
+        }
+        out += "\n";
+        for (int c = 0; c < counterCount; ++c) {
+            out += std::string(counterName(static_cast<Counter>(c))) + " " + std::to_string(counters[c]);
+            out += c + 1 < counterCount ? "   " : "";
+        }
+        return out;
+    }
+
+private:
+    std::string duration(double ticks) const {
+        const double ns = ticks * nanosPerTick;
+        char tmp[32];
+        if (ns < 1e3) std::snprintf(tmp, sizeof tmp, "%.0fns", ns);
+        else if (ns < 1e6) std::snprintf(tmp, sizeof tmp, "%.1fus", ns / 1e3);
+        else if (ns < 1e9) std::snprintf(tmp, sizeof tmp, "%.1fms", ns / 1e6);
+        else std::snprintf(tmp, sizeof tmp, "%.2fs", ns / 1e9);
+        return tmp;
+    }
+};
+
+//------Every thread's shard-------//
+// Shards are created on a thread's first sample and registered here. When the
+// thread ends its shard is folded into `retired`, so samples from finished
+// server or scheduler threads still count.
+class MetricsRegistry {
+public:
+    MetricsRegistry() : originTicks(metricTicks()), originTime(std::chrono::steady_clock::now()) {}
+
+    void attach(MetricsShard* s) {
+        std::lock_guard<std::mutex> lock(m);
+        live.push_back(s);
+    }
+
+    void detach(MetricsShard* s) {
+        std::lock_guard<std::mutex> lock(m);
+        live.erase(std::find(live.begin(), live.end(), s));
+        retired.add(*s);
+    }
+
+    MetricsSnapshot read() {
+        MetricsSnapshot snap;
+        {
+            std::lock_guard<std::mutex> lock(m);
+            snap = retired;
+            for (const MetricsShard* s : live) snap.add(*s);
+            snap.threads = static_cast<unsigned>(live.size());
+        }
+#ifdef CASINO_METRICS_TSC
+        // The tick rate is measured against steady_clock since the first sample
+        if (std::chrono::steady_clock::now() - originTime < std::chrono::milliseconds(20))
+            std::this_thread::sleep_until(originTime + std::chrono::milliseconds(20));
+        const uint64_t ticks = metricTicks() - originTicks;
+        const double nanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - originTime).count();
+        snap.nanosPerTick = ticks ? nanos / static_cast<double>(ticks) : 1.0;
+#else
+        snap.nanosPerTick = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::duration(1)).count();
+#endif
+        return snap;
+    }
+
+private:
+    std::mutex m;
+    std::vector<MetricsShard*> live;
+    MetricsSnapshot retired;
+    const uint64_t originTicks;
+    const std::chrono::steady_clock::time_point originTime;
+};
+
+// Never destroyed: threads owned by other statics (the job scheduler's
+// workers) still fold their shards in while the program exits
+inline MetricsRegistry& metricsRegistry() {
+    static MetricsRegistry* registry = new MetricsRegistry;
+    return *registry;
+}
+
+// Where operator new counts; null until the thread's shard exists and after it is gone
+inline std::atomic<uint64_t>*& allocationCounter() {
+    thread_local std::atomic<uint64_t>* counter = nullptr;
+    return counter;
+}
+
+class ThreadMetrics {
+public:
+    ThreadMetrics() : shard(new MetricsShard) {
+        metricsRegistry().attach(shard);
+        allocationCounter() = &shard->counters[static_cast<int>(Counter::Allocations)];
+    }
+    ~ThreadMetrics() {
+        allocationCounter() = nullptr;
+        metricsRegistry().detach(shard);
+        delete shard;
+    }
+    ThreadMetrics(const ThreadMetrics&) = delete;
+    ThreadMetrics& operator=(const ThreadMetrics&) = delete;
+
+    MetricsShard* const shard;
+};
+
+// This thread's shard
+inline MetricsShard& metrics() {
+    thread_local ThreadMetrics mine;
+    return *mine.shard;
+}
+
+inline void countMetric(Counter c, uint64_t n = 1) { metrics().count(c, n); }
+
+// Times its scope as one sample of `phase`
+class PhaseTimer {
+public:
+    explicit PhaseTimer(Phase p) : phase(p), start(metricTicks()) {}
+    ~PhaseTimer() { metrics().phases[static_cast<int>(phase)].record(metricTicks() - start); }
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+private:
+    const Phase phase;
+    const uint64_t start;
+};
+
+// Every thread's samples so far, merged
+inline MetricsSnapshot readMetrics() { return metricsRegistry().read(); }
+
+//------Allocation counting-------//
+// The replacement global operator new (in CasinoTextBasedGame.cpp, since it
+// may be defined once only) calls this. Threads that have not recorded
+// anything yet are not counted.
+inline void countAllocation() {
+    if (std::atomic<uint64_t>* c = allocationCounter()) c->store(c->load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
@@ -1,5 +1,7 @@
 ﻿#pragma once
 #include "Main.h"
+#include "GameRegistry.h"
+#include "View.h"
 #include <array>
 #include <numeric>
 #include <algorithm>
@@ -17,13 +19,15 @@ constexpr const T& clamp(const T& v, const T& lo, const T& hi) {
     return (v < lo) ? lo : (hi < v) ? hi : v;
 }
 
-class Poker {
+// View is ConsoleView or NullView (View.h); see the Poker alias below
+template <typename View = ConsoleView>
+class BasicPoker {
 public:
     int handCount = 0;            // counts how many hands have been played
     int blindIncreaseInterval = 5; // increase blinds every 5 hands
     int blindIncreaseAmount = 5;   // amount to increase SB/BB
 
-    Poker(int totalPlayers = 6)
+    BasicPoker(int totalPlayers = 6)
         : numPlayers(clamp(totalPlayers, 2, 9)),
         smallBlind(10), bigBlind(20), dealerPosition(0) {
     }
@@ -40,18 +44,19 @@ public:
         }
     };
 
-    void play(Player& player, CasinoManager &casino) {
-        system("cls");
-        drawAsciiBox("=== Welcome To Poker ===");
+    Task<void> play(Player& player, CasinoManager &casino) {
+        TraceSpan span("Poker::play");
+        view.clear();
+        view.box("=== Welcome To Poker ===");
 
         handCount++;
         if (handCount % blindIncreaseInterval == 0) {
             smallBlind += blindIncreaseAmount;
             bigBlind += blindIncreaseAmount;
-            drawAsciiBox(
+            view.box(
                 "Blinds increased!\n"
-                "Small Blind: " + std::to_string(smallBlind) +
-                "\nBig Blind: " + std::to_string(bigBlind)
+                "Small Blind: ", smallBlind,
+                "\nBig Blind: ", bigBlind
             );
         }
 
@@ -87,8 +92,8 @@ public:
         if (player.hasCurse("Unlucky Hand"))
             applyUnluckyHandToStarting(playersHands[0]);
 
-        std::cout << "\nYour hole cards:\n";
-        displayCards(playersHands[0], false);
+        view.print("\nYour hole cards:\n");
+        view.cards(playersHands[0]);
 
         // Pay blinds
         playerBets[smallBlindPos] = smallBlind;
@@ -98,9 +103,10 @@ public:
 
         // --- PRE-FLOP ---
         // (No community cards yet)
-        if (!bettingRound(player, "Pre-Flop", casino)) {
-            concludeAfterFold(player, casino);
-            return;
+        bool stillIn = co_await bettingRound(player, "Pre-Flop", casino);
+        if (!stillIn) {
+            co_await concludeAfterFold(player, casino);
+            co_return;
         }
 
         // --- FLOP ---
@@ -108,25 +114,28 @@ public:
         burn();
         for (int i = 0; i < 3; ++i)
             community.push_back(deck.dealCard()); // flop
-        if (!bettingRound(player, "Flop", casino)) {
-            concludeAfterFold(player, casino);
-            return;
+        stillIn = co_await bettingRound(player, "Flop", casino);
+        if (!stillIn) {
+            co_await concludeAfterFold(player, casino);
+            co_return;
         }
 
         // --- TURN ---
         burn();
         community.push_back(deck.dealCard());
-        if (!bettingRound(player, "Turn", casino)) {
-            concludeAfterFold(player, casino);
-            return;
+        stillIn = co_await bettingRound(player, "Turn", casino);
+        if (!stillIn) {
+            co_await concludeAfterFold(player, casino);
+            co_return;
         }
 
         // --- RIVER ---
         burn();
         community.push_back(deck.dealCard());
-        if (!bettingRound(player, "River", casino)) {
-            concludeAfterFold(player, casino);
-            return;
+        stillIn = co_await bettingRound(player, "River", casino);
+        if (!stillIn) {
+            co_await concludeAfterFold(player, casino);
+            co_return;
         }
 
         // --- SHOWDOWN ---
@@ -135,12 +144,13 @@ public:
         // Move dealer button
         dealerPosition = (dealerPosition + 1) % numPlayers;
         player.regenerateMana();
-        player.decayCurses();
+        player.decayCurses(View::enabled);
         player.clearBlessings();
-        pauseEnter();
+        co_await casino.input.pauseEnter();
     }
 
 private:
+    View view;
     Deck deck;
     int numPlayers;
     int smallBlind, bigBlind;
@@ -156,71 +166,63 @@ private:
 
     void burn() { (void)deck.dealCard(); }
 
-    void displayCards(const std::vector<Card>& cards, bool hideFirst = false) const {
-        std::vector<std::vector<std::string>> arts;
-        for (size_t i = 0; i < cards.size(); ++i) {
-            if (i == 0 && hideFirst) arts.push_back(Card::hiddenCard());
-            else arts.push_back(cards[i].displayCard());
-        }
-        for (size_t line = 0; line < arts[0].size(); ++line) {
-            for (size_t c = 0; c < arts.size(); ++c)
-                std::cout << arts[c][line] << " ";
-            std::cout << "\n";
-        }
-    }
+    // Composes the whole table into `out` so it reaches the terminal as one frame
+    void displayTable(FrameBuffer& out, const Player& player) const {
+        drawAsciiBox(out, "=== TABLE ===");
 
-    void displayTable(const Player& player) const {
-        drawAsciiBox("=== TABLE ===");
+        out << "Dealer Button: Seat " << dealerPosition + 1 << "\n";
+        out << "Small Blind: " << smallBlind << " | Big Blind: " << bigBlind << "\n";
+        out << "Pot: " << pot << " chips\n\n";
 
-        std::cout << "Dealer Button: Seat " << dealerPosition + 1 << "\n";
-        std::cout << "Small Blind: " << smallBlind << " | Big Blind: " << bigBlind << "\n";
-        std::cout << "Pot: " << pot << " chips\n\n";
-
-        std::cout << "Community Cards:\n";
-        if (!community.empty()) displayCards(community, false);
-        std::cout << "\n\nPlayers:\n";
+        out << "Community Cards:\n";
+        if (!community.empty()) drawCardRow(out, community, false);
+        out << "\n\nPlayers:\n";
 
         for (int i = 0; i < numPlayers; ++i) {
-            std::cout << "Seat " << i + 1 << ": ";
+            out << "Seat " << i + 1 << ": ";
 
             if (i == dealerPosition)
-                std::cout << "(D) ";
+                out << "(D) ";
 
             if (!active[i])
-                std::cout << "[X] Folded";
+                out << "[X] Folded";
             else if (i == 0)
-                std::cout << "You - Bet: " << playerBets[i];
+                out << "You - Bet: " << playerBets[i];
             else
-                std::cout << "Opponent " << i << " - Bet: " << playerBets[i] << " (cards hidden)";
+                out << "Opponent " << i << " - Bet: " << playerBets[i] << " (cards hidden)";
 
-            std::cout << "\n";
+            out << "\n";
         }
-        std::cout << "\n";
-        player.showStatus();
+        out << "\n";
+        player.showStatus(out);
     }
 
-    bool bettingRound(Player& player, const std::string& stage, CasinoManager &casino) {
+    Task<bool> bettingRound(Player& player, const std::string& stage, CasinoManager &casino) {
+        TraceSpan span("Poker::bettingRound", stage);
         
-        drawAsciiBox("=== " + stage + " ===");
-        displayTable(player);
-
         // reset bets
         std::vector<int> totalBets(numPlayers, 0);
         currentBet = 0;
 
         // Player turn
-        while (true) {
-            std::cout << "\nYour hole cards:\n";
-            displayCards(playersHands[0], false);
+        for (bool firstPass = true; ; firstPass = false) {
+            view.draw([&](FrameBuffer& out) {
+                if (firstPass) {
+                    drawAsciiBox(out, "=== " + stage + " ===");
+                    displayTable(out, player);
+                }
+                out << "\nYour hole cards:\n";
+                drawCardRow(out, playersHands[0], false);
 
-            std::cout << "\n1. Fold\n2. Check/Call\n3. Raise\nChoice: ";
-            int choice = readInt("", 1, 3);
+                out << "\n1. Fold\n2. Check/Call\n3. Raise\n";
+            });
+            int choice = co_await casino.input.readChoice("Choice: ", 1, 3);
 
             if (choice == 1) {
                 folded[0] = true;
                 active[0] = false;
-                drawAsciiBox("You folded.");
-                return false;
+                view.box("You folded.");
+                co_return false;
             }
             else if (choice == 2) {
 				currentBet = std::max(currentBet, static_cast<int>(playerBets[0]));
@@ -228,26 +230,26 @@ private:
                     currentBet = std::max(currentBet, static_cast<int>(playerBets[i]));
                 }
                 if (currentBet == playerBets[0]) {
-                    drawAsciiBox("You check.");
+                    view.box("You check.");
                     break; // no bet to call
 				}
                 else if (currentBet > playerBets[0]) {
                     double callAmt;
 					callAmt = currentBet - playerBets[0];
-					std::cout << "You need to call " << callAmt << " chips.\n";
+					view.print("You need to call ", callAmt, " chips.\n");
                     if (callAmt > player.getBalance()) {
-                        drawAsciiBox("Insufficient funds to call. You go all-in with your remaining balance.");
+                        view.box("Insufficient funds to call. You go all-in with your remaining balance.");
                         callAmt = player.getBalance();
 					}
                     else if (callAmt <= 0) {
-                        drawAsciiBox("You check.");
+                        view.box("You check.");
 						break;
 					}
                     else {
-                        if (callAmt > 0) casino.placeBet(callAmt, callAmt, callAmt);
+                        if (callAmt > 0) co_await casino.placeBet(callAmt, callAmt, callAmt, View::enabled);
                         playerBets[0] += callAmt;
                         pot += callAmt;
-                        drawAsciiBox("You call " + std::to_string(callAmt));
+                        view.box("You call ", Fixed{ callAmt, 6 });
                         totalBets[0] += callAmt;
                         break;
                     }
@@ -256,11 +258,11 @@ private:
             }
             else if (choice == 3) {
                 double raiseAmt;
-                casino.placeBet(raiseAmt, currentBet + 10, currentBet + 100);
+                co_await casino.placeBet(raiseAmt, currentBet + 10, currentBet + 100, View::enabled);
                 playerBets[0] += raiseAmt;
                 pot += raiseAmt;
                 currentBet = raiseAmt;
-                drawAsciiBox("You raised to " + std::to_string(raiseAmt));
+                view.box("You raised to ", Fixed{ raiseAmt, 6 });
                 break;
             }
         }
@@ -326,17 +328,18 @@ private:
         int activeCount = 0;
         for (int i = 0; i < numPlayers; ++i) if (active[i]) ++activeCount;
         if (activeCount == 1 && active[0]) {
-            drawAsciiBox("All opponents folded. You win the pot!");
-            casino.processWin(static_cast<double>(pot), 1.0); // give player pot
-            return true;
+            view.box("All opponents folded. You win the pot!");
+            casino.processWin(static_cast<double>(pot), 1.0, View::enabled); // give player pot
+            co_return true;
         }
 
-        return true;
+        co_return true;
     }
 
     void showdown(Player& player, CasinoManager &casino) {
-        drawAsciiBox("=== SHOWDOWN ===");
-        displayCards(community, false);
+        TraceSpan span("Poker::showdown");
+        view.box("=== SHOWDOWN ===");
+        view.cards(community);
 
         std::vector<HandRank> ranks(numPlayers);
         for (int p = 0; p < numPlayers; ++p)
@@ -350,42 +353,43 @@ private:
         for (int p = 0; p < numPlayers; ++p)
             if (active[p] && !(ranks[p] < best) && !(best < ranks[p])) winners.push_back(p);
 
-        if (winners.empty()) drawAsciiBox("No winners!");
+        if (winners.empty()) view.box("No winners!");
         else if (winners.size() == 1) {
             int w = winners[0];
             if (w == 0) {
-                drawAsciiBox("You win the pot of " + std::to_string(pot) + "!");
-				casino.processWin(pot, 1.0);
+                view.box("You win the pot of ", pot, "!");
+				casino.processWin(pot, 1.0, View::enabled);
             }
             else {
-                drawAsciiBox("Opponents Hand");
-				displayCards(playersHands[w], false);
-                drawAsciiBox("Opponent " + std::to_string(w + 1) + " has " + handRankName(ranks[w].rank) + ".");
-                drawAsciiBox("Opponent " + std::to_string(w + 1) + " wins the pot.");
-				casino.processLoss(playerBets[0]);
+                view.box("Opponents Hand");
+				view.cards(playersHands[w]);
+                view.box("Opponent ", w + 1, " has ", handRankName(ranks[w].rank), ".");
+                view.box("Opponent ", w + 1, " wins the pot.");
+				casino.processLoss(playerBets[0], View::enabled);
             }
         }
         else {
-            drawAsciiBox("Pot is split between winners!");
+            view.box("Pot is split between winners!");
             for (int i = 0; i < winners.size(); ++i) {
-                displayCards(playersHands[winners[i]], false);
+                view.cards(playersHands[winners[i]]);
             }
-			casino.processWin(pot / winners.size());
+			casino.processWin(pot / winners.size(), 2.0, View::enabled);
         }
     }
 
-    void concludeAfterFold(Player& player, CasinoManager &casino) {
-        drawAsciiBox("You folded the hand.");
-		casino.processLoss(playerBets[0]);
-        maybeApplyRandomCurseAfterLoss(player);
+    Task<void> concludeAfterFold(Player& player, CasinoManager &casino) {
+        view.box("You folded the hand.");
+		casino.processLoss(playerBets[0], View::enabled);
+        maybeApplyRandomCurseAfterLoss(player, View::enabled);
         player.regenerateMana();
-        player.decayCurses();
+        player.decayCurses(View::enabled);
         player.clearBlessings();
-        pauseEnter();
+        co_await casino.input.pauseEnter();
     }
 
+public:
     // ---------------------
-    // Hand evaluation helpers
+    // Hand evaluation helpers (also used by the offline simulator)
     // ---------------------
 
     // Return list of indices combinations (n choose k). We'll use this to generate all 5-card combos from 7 cards.
@@ -401,6 +405,7 @@ private:
 
     // Evaluate a 5-card hand and return HandRank
     HandRank evaluate5(const std::array<Card, 5>& hand) const {
+        countMetric(Counter::EvaluatorCalls);
         // Convert ranks to ints (Ace high = 14)
         std::array<int, 5> vals;
         std::array<int, 5> suits;
@@ -530,6 +535,7 @@ private:
     }
 
     HandRank bestHandFromSeven(const std::vector<Card>& hole, const std::vector<Card>& comm) const {
+        PhaseTimer timing(Phase::Evaluate);
         std::array<Card, 7> all{{
             Card(Card::Two, Card::Hearts), Card(Card::Two, Card::Hearts), Card(Card::Two, Card::Hearts),
             Card(Card::Two, Card::Hearts), Card(Card::Two, Card::Hearts), Card(Card::Two, Card::Hearts),
@@ -565,3 +571,7 @@ private:
         return names[r];
     }
 };
+
+// The casino table
+using Poker = BasicPoker<ConsoleView>;
+inline const bool pokerRegistered = registerGame<Poker, BasicPoker<NullView>>({ "Poker", "Poker (Texas Hold'em)", 2, KeepsShoe });
@@ -0,0 +1,141 @@
+﻿#pragma once
+#include "Main.h"
+#include "SaveGame.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+//================== Progressive Jackpot ==================//
+//------One pool shared by every session and simulator thread-------//
+// The pool is held in fixed-point micro-pounds, split over cache-line sized
+// shards. Each thread always adds to its own shard, so contributions never
+// contend on one counter. Reading the pool sums the shards; claiming it swaps
+// every shard to zero. Contributions that race with a claim roll into the next
+// pool, and a second winner in the same instant still gets at least the seed.
+class ProgressiveJackpot {
+public:
+    static constexpr int shardCount = 16;
+    static constexpr double microsPerPound = 1e6;
+
+    explicit ProgressiveJackpot(double seedValue = 500.0) : seed(toMicros(seedValue)) {}
+
+    // Lock-free; safe from any thread
+    void contribute(double amount) {
+        shards[shardIndex()].micros.fetch_add(toMicros(amount), std::memory_order_relaxed);
+    }
+
+    double value() const { return static_cast<double>(seed + pooled()) / microsPerPound; }
+
+    // Takes the whole pool (seed included) and resets it to the seed
+    double claim() {
+        uint64_t won = seed;
+        for (auto& s : shards) won += s.micros.exchange(0, std::memory_order_acq_rel);
+        hits.fetch_add(1, std::memory_order_relaxed);
+        lastWin.store(won, std::memory_order_relaxed);
+        return static_cast<double>(won) / microsPerPound;
+    }
+
+    uint64_t hitCount() const { return hits.load(std::memory_order_relaxed); }
+    double lastWinAmount() const { return static_cast<double>(lastWin.load(std::memory_order_relaxed)) / microsPerPound; }
+    double seedValue() const { return static_cast<double>(seed) / microsPerPound; }
+
+    // Snapshot as "pool <micros> hits <n> last <micros>", replacing the old
+    // file in one step the way profiles are saved (replaceFile, SaveGame.h)
+    bool save(const std::string& path) const {
+        std::ostringstream out;
+        out << "pool " << pooled() << " hits " << hitCount() << " last " << lastWin.load(std::memory_order_relaxed) << "\n";
+        std::string error;
+        return replaceFile(path, out.str(), error);
+    }
+
+    // Restores a saved pool into shard 0; call before play starts
+    bool load(const std::string& path) {
+        std::ifstream in(path);
+        std::string k1, k2, k3;
+        uint64_t pool = 0, n = 0, last = 0;
+        if (!(in >> k1 >> pool >> k2 >> n >> k3 >> last) || k1 != "pool" || k2 != "hits" || k3 != "last") return false;
+        for (auto& s : shards) s.micros.store(0, std::memory_order_relaxed);
+        shards[0].micros.store(pool, std::memory_order_relaxed);
+        hits.store(n, std::memory_order_relaxed);
+        lastWin.store(last, std::memory_order_relaxed);
+        return true;
+    }
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> micros{ 0 };
+    };
+
+    Shard shards[shardCount];
+    const uint64_t seed;
+    std::atomic<uint64_t> hits{ 0 };
+    std::atomic<uint64_t> lastWin{ 0 };
+
+    static uint64_t toMicros(double pounds) { return pounds > 0.0 ? static_cast<uint64_t>(pounds * microsPerPound + 0.5) : 0; }
+
+    uint64_t pooled() const {
+        uint64_t total = 0;
+        for (const auto& s : shards) total += s.micros.load(std::memory_order_relaxed);
+        return total;
+    }
+
+    static int shardIndex() {
+        static std::atomic<unsigned> nextThread{ 0 };
+        thread_local const int index = static_cast<int>(nextThread.fetch_add(1, std::memory_order_relaxed) % shardCount);
+        return index;
+    }
+};
+
+//------Background persistence-------//
+// Saves the pool every `interval` from its own thread. Spins never wait on it:
+// the saver only reads the atomics, and its mutex guards nothing but its sleep.
+class JackpotPersister {
+public:
+    JackpotPersister(const ProgressiveJackpot& pool, std::string path, std::chrono::milliseconds interval = std::chrono::seconds(5))
+        : pool(pool), path(std::move(path)), interval(interval), worker([this]() { run(); }) {}
+
+    ~JackpotPersister() {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            stopping = true;
+        }
+        cv.notify_one();
+        worker.join();
+        pool.save(path); // final snapshot on shutdown
+    }
+
+    JackpotPersister(const JackpotPersister&) = delete;
+    JackpotPersister& operator=(const JackpotPersister&) = delete;
+
+private:
+    const ProgressiveJackpot& pool;
+    const std::string path;
+    const std::chrono::milliseconds interval;
+    std::mutex m;
+    std::condition_variable cv;
+    bool stopping = false;
+    std::thread worker;
+
+    void run() {
+        std::unique_lock<std::mutex> lock(m);
+        while (!cv.wait_for(lock, interval, [this]() { return stopping; })) {
+            lock.unlock();
+            pool.save(path);
+            lock.lock();
+        }
+    }
+};
+
+// The casino-wide pool, restored from jackpot.dat on first use and saved in the background
+ProgressiveJackpot& progressiveJackpot(double seedValue = 500.0) {
+    static ProgressiveJackpot pool(seedValue);
+    static bool restored = pool.load("jackpot.dat");
+    static JackpotPersister persister(pool, "jackpot.dat");
+    (void)restored;
+    return pool;
+}
@@ -0,0 +1,107 @@
+﻿#pragma once
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include "Coroutine.h"
+#include "Metrics.h"
+#include "Trace.h"
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+// A number written with a fixed count of decimals, e.g. money as Fixed{ bet }
+struct Fixed {
+    double value;
+    int places = 2;
+};
+
+//================== Frame Buffer ==================//
+//------A whole screen composed in one reusable UTF-8 buffer-------//
+// Drawing code appends into the frame and nothing reaches the terminal until
+// present(), which hands the finished frame to the OS in a single write. The
+// buffer keeps its capacity between frames, so steady-state drawing does not
+// allocate, and the terminal never shows a half-drawn table.
+class FrameBuffer {
+public:
+    FrameBuffer() { buf.reserve(16 * 1024); }
+
+    FrameBuffer& operator<<(std::string_view s) { buf.append(s.data(), s.size()); return *this; }
+    FrameBuffer& operator<<(const char* s) { return *this << std::string_view(s); }
+    FrameBuffer& operator<<(const std::string& s) { buf.append(s); return *this; }
+    FrameBuffer& operator<<(char c) { buf.push_back(c); return *this; }
+    template <typename T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, char>::value && !std::is_same<T, bool>::value, int>::type = 0>
+    FrameBuffer& operator<<(T v) {
+        if (std::is_signed<T>::value) return number("%lld", static_cast<long long>(v));
+        return number("%llu", static_cast<unsigned long long>(v));
+    }
+    // Same shortest form std::cout prints for a double by default
+    FrameBuffer& operator<<(double v) { return number("%g", v); }
+    FrameBuffer& operator<<(Fixed v) {
+        char tmp[64];
+        const int n = std::snprintf(tmp, sizeof tmp, "%.*f", v.places, v.value);
+        if (n > 0) buf.append(tmp, static_cast<size_t>(n) < sizeof tmp ? static_cast<size_t>(n) : sizeof tmp - 1);
+        return *this;
+    }
+
+    FrameBuffer& repeat(std::string_view s, size_t n) {
+        for (size_t i = 0; i < n; ++i) buf.append(s.data(), s.size());
+        return *this;
+    }
+    FrameBuffer& spaces(size_t n) { buf.append(n, ' '); return *this; }
+
+    bool empty() const { return buf.empty(); }
+    size_t size() const { return buf.size(); }
+    std::string_view view() const { return buf; }
+    void clear() { buf.clear(); }
+
+    // Writes the composed frame in one call and starts the next one
+    void present() {
+        if (buf.empty()) return;
+        PhaseTimer timing(Phase::Render);
+        TraceSpan span("render");
+        if (std::string* capture = sessionContext().output) capture->append(buf);
+        else {
+            std::cout.flush(); // keep ordering with anything already streamed to cout
+            writeAll(buf.data(), buf.size());
+        }
+        buf.clear();
+    }
+
+private:
+    std::string buf;
+
+    template <typename T>
+    FrameBuffer& number(const char* fmt, T v) {
+        char tmp[32];
+        const int n = std::snprintf(tmp, sizeof tmp, fmt, v);
+        if (n > 0) buf.append(tmp, static_cast<size_t>(n) < sizeof tmp ? static_cast<size_t>(n) : sizeof tmp - 1);
+        return *this;
+    }
+
+    static void writeAll(const char* p, size_t n) {
+        while (n > 0) {
+#ifdef _WIN32
+            const int chunk = n > 0x40000000 ? 0x40000000 : static_cast<int>(n);
+            const int w = _write(1, p, chunk);
+            if (w <= 0) return;
+#else
+            const ssize_t w = ::write(1, p, n);
+            if (w < 0 && errno == EINTR) continue;
+            if (w <= 0) return;
+#endif
+            p += w;
+            n -= static_cast<size_t>(w);
+        }
+    }
+};
+
+// The frame every screen on this thread is composed into
+inline FrameBuffer& frame() {
+    thread_local FrameBuffer f;
+    return f;
+}
@@ -0,0 +1,433 @@
+﻿#pragma once
+#include "Main.h"
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#ifdef _WIN32
+#include <io.h>
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+//================== Saved Profiles ==================//
+//------Format-------//
+// One small file per profile: <dir>/<name>-<hash>.sav. The file name comes
+// from the player's name alone, so startup opens exactly one file however
+// many profiles exist, and never lists the directory.
+//
+// A file is a 16-byte header and a payload, all little-endian:
+//   header   "CSAV", version u16, header size u16, payload size u32, CRC-32 of the payload u32
+//   payload  name (u16 length + bytes), balance i64, mana i32, blessings u8 (bit 0 Lucky Draw,
+//            1 Fate's Glimpse, 2 Mana Shield), curses u16 count x (name, rounds i32),
+//            earnings i64, losses i64, saved-at i64
+// Money is in whole micro-pounds and times are Unix seconds. A reader takes
+// any version up to its own; a later version only appends payload fields.
+constexpr uint16_t profileVersion = 1;
+constexpr size_t profileHeaderSize = 16;
+
+struct ProfileSnapshot {
+    std::string name;
+    int64_t balance = 0;
+    int32_t mana = 0;
+    uint8_t blessings = 0;
+    std::vector<ActiveCurse> curses;
+    int64_t earnings = 0;
+    int64_t losses = 0;
+    int64_t savedAt = 0;
+
+    // The session as it stands now
+    static ProfileSnapshot of(const CasinoManager& casino) {
+        const Player& player = casino.player;
+        ProfileSnapshot s;
+        s.name = player.getName();
+        s.balance = toEventMicros(player.getBalance());
+        s.mana = player.getMana();
+        s.blessings = static_cast<uint8_t>((player.luckyDraw ? 1 : 0) | (player.fateGlimpse ? 2 : 0) | (player.manaShield ? 4 : 0));
+        s.curses = player.getCurses();
+        s.earnings = toEventMicros(casino.totalEarnings);
+        s.losses = toEventMicros(casino.totalLosses);
+        s.savedAt = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        return s;
+    }
+
+    // Puts the saved player and session totals back
+    void applyTo(CasinoManager& casino) const {
+        Player& player = casino.player;
+        player.restore(balance / 1e6, mana, curses);
+        player.luckyDraw = (blessings & 1) != 0;
+        player.fateGlimpse = (blessings & 2) != 0;
+        player.manaShield = (blessings & 4) != 0;
+        casino.totalEarnings = earnings / 1e6;
+        casino.totalLosses = losses / 1e6;
+    }
+};
+
+// CRC-32 (IEEE, as in zip and PNG), table built at compile time
+inline uint32_t crc32(const void* data, size_t size) {
+    static constexpr auto table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    uint32_t c = 0xFFFFFFFFu;
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) c = table[(c ^ p[i]) & 0xFF] ^ (c >> 8);
+    return c ^ 0xFFFFFFFFu;
+}
+
+//------Encoding-------//
+class ProfileWriter {
+public:
+    explicit ProfileWriter(std::string& out) : out(out) {}
+
+    template <typename T>
+    void put(T value) {
+        const uint64_t v = static_cast<uint64_t>(value);
+        for (size_t i = 0; i < sizeof(T); ++i) out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+    }
+    void put(const std::string& text) {
+        const size_t n = std::min<size_t>(text.size(), UINT16_MAX);
+        put(static_cast<uint16_t>(n));
+        out.append(text, 0, n);
+    }
+
+private:
+    std::string& out;
+};
+
+// Reads fields in order; once anything runs past the end every later get() fails too
+class ProfileReader {
+public:
+    ProfileReader(const char* data, size_t size) : p(data), end(data + size) {}
+
+    template <typename T>
+    bool get(T& value) {
+        if (static_cast<size_t>(end - p) < sizeof(T)) return ok = false;
+        uint64_t v = 0;
+        for (size_t i = 0; i < sizeof(T); ++i) v |= static_cast<uint64_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+        p += sizeof(T);
+        value = static_cast<T>(v);
+        return ok;
+    }
+    bool get(std::string& text) {
+        uint16_t n = 0;
+        if (!get(n) || static_cast<size_t>(end - p) < n) return ok = false;
+        text.assign(p, n);
+        p += n;
+        return ok;
+    }
+    bool good() const { return ok; }
+
+private:
+    const char* p;
+    const char* end;
+    bool ok = true;
+};
+
+inline void encodeProfile(const ProfileSnapshot& s, std::string& bytes) {
+    bytes.assign(profileHeaderSize, '\0');
+    ProfileWriter w(bytes);
+    w.put(s.name);
+    w.put(s.balance);
+    w.put(s.mana);
+    w.put(s.blessings);
+    w.put(static_cast<uint16_t>(std::min<size_t>(s.curses.size(), UINT16_MAX)));
+    for (size_t i = 0; i < s.curses.size() && i < UINT16_MAX; ++i) {
+        w.put(s.curses[i].name);
+        w.put(static_cast<int32_t>(s.curses[i].remainingRounds));
+    }
+    w.put(s.earnings);
+    w.put(s.losses);
+    w.put(s.savedAt);
+
+    std::string header;
+    ProfileWriter h(header);
+    header.append("CSAV", 4);
+    h.put(profileVersion);
+    h.put(static_cast<uint16_t>(profileHeaderSize));
+    h.put(static_cast<uint32_t>(bytes.size() - profileHeaderSize));
+    h.put(crc32(bytes.data() + profileHeaderSize, bytes.size() - profileHeaderSize));
+    bytes.replace(0, profileHeaderSize, header);
+}
+
+inline bool decodeProfile(const char* data, size_t size, ProfileSnapshot& s, std::string& error) {
+    ProfileReader h(data, size);
+    uint16_t version = 0, headerSize = 0;
+    uint32_t payloadSize = 0, checksum = 0;
+    if (size < profileHeaderSize || std::memcmp(data, "CSAV", 4) != 0) {
+        error = "not a profile file";
+        return false;
+    }
+    uint32_t magic;
+    h.get(magic);
+    h.get(version);
+    h.get(headerSize);
+    h.get(payloadSize);
+    h.get(checksum);
+    if (version == 0 || version > profileVersion) {
+        error = "saved by a newer version (format " + std::to_string(version) + ")";
+        return false;
+    }
+    if (headerSize < profileHeaderSize || headerSize > size || size - headerSize != payloadSize) {
+        error = "truncated";
+        return false;
+    }
+    if (crc32(data + headerSize, payloadSize) != checksum) {
+        error = "checksum mismatch";
+        return false;
+    }
+
+    ProfileReader r(data + headerSize, payloadSize);
+    uint16_t curseCount = 0;
+    r.get(s.name);
+    r.get(s.balance);
+    r.get(s.mana);
+    r.get(s.blessings);
+    r.get(curseCount);
+    s.curses.clear();
+    for (uint16_t i = 0; i < curseCount && r.good(); ++i) {
+        ActiveCurse c;
+        int32_t rounds = 0;
+        r.get(c.name);
+        r.get(rounds);
+        c.remainingRounds = rounds;
+        s.curses.push_back(std::move(c));
+    }
+    r.get(s.earnings);
+    r.get(s.losses);
+    r.get(s.savedAt);
+    if (!r.good()) {
+        error = "payload too short";
+        return false;
+    }
+    return true;
+}
+
+//------Durable replace-------//
+// Writes `bytes` to <path>.tmp, flushes it to disk, then renames it over
+// `path`, which rename (MoveFileEx on Windows) replaces in one step. A crash
+// at any point leaves either the old file or the new one, never neither.
+inline bool replaceFile(const std::string& path, const std::string& bytes, std::string& error) {
+    const std::string tmp = path + ".tmp";
+    std::FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) {
+        error = "Cannot write " + tmp;
+        return false;
+    }
+    bool ok = std::fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size() && std::fflush(f) == 0;
+#ifdef _WIN32
+    ok = ok && _commit(_fileno(f)) == 0;
+#else
+    ok = ok && fsync(fileno(f)) == 0;
+#endif
+    ok = std::fclose(f) == 0 && ok;
+#ifdef _WIN32
+    ok = ok && MoveFileExA(tmp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    ok = ok && std::rename(tmp.c_str(), path.c_str()) == 0;
+    if (ok) { // make the rename itself durable
+        const std::string dir = std::filesystem::path(path).parent_path().string();
+        const int d = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY);
+        if (d >= 0) {
+            (void)fsync(d);
+            ::close(d);
+        }
+    }
+#endif
+    if (!ok) {
+        std::remove(tmp.c_str());
+        error = "Could not save " + path;
+    }
+    return ok;
+}
+
+//------Store-------//
+// Saves go to <file>.tmp, are flushed to disk, then renamed over the old file,
+// so a crash mid-save leaves the previous profile intact. A file that fails
+// its checks is moved aside to <file>.bad rather than overwritten later.
+class ProfileStore {
+public:
+    // An empty directory disables saving and loading
+    explicit ProfileStore(std::string directory = "saves") : dir(std::move(directory)) {}
+
+    bool enabled() const { return !dir.empty(); }
+    const std::string& directory() const { return dir; }
+
+    // Lower-cased letters, digits, '-' and '_' of the name (at most 40), then
+    // an FNV-1a hash of the exact name, so "Bob" and "bob" never share a file
+    std::string pathFor(const std::string& name) const {
+        std::string stem;
+        uint32_t hash = 2166136261u;
+        for (unsigned char c : name) {
+            hash = (hash ^ c) * 16777619u;
+            if (stem.size() < 40 && c < 0x80 && (std::isalnum(c) || c == '-' || c == '_')) stem.push_back(static_cast<char>(std::tolower(c)));
+        }
+        char suffix[16];
+        std::snprintf(suffix, sizeof suffix, "-%08x.sav", hash);
+        return dir + "/" + stem + suffix;
+    }
+
+    // False with an empty error when the name has no profile yet
+    bool load(const std::string& name, ProfileSnapshot& s, std::string& error) const {
+        error.clear();
+        if (!enabled()) return false;
+        const std::string path = pathFor(name);
+        std::FILE* f = std::fopen(path.c_str(), "rb");
+        if (!f) return false;
+        char buffer[4096];
+        std::string bytes;
+        size_t n;
+        while ((n = std::fread(buffer, 1, sizeof buffer, f)) > 0) bytes.append(buffer, n);
+        std::fclose(f);
+
+        if (decodeProfile(bytes.data(), bytes.size(), s, error) && s.name == name) return true;
+        if (error.empty()) error = "belongs to " + s.name;
+        error = "Saved profile " + path + " is unreadable: " + error + ".";
+        if (std::rename(path.c_str(), (path + ".bad").c_str()) == 0) error += "\nIt was kept as " + path + ".bad.";
+        return false;
+    }
+
+    bool save(const ProfileSnapshot& s, std::string& error) const {
+        std::string bytes;
+        encodeProfile(s, bytes);
+        return write(pathFor(s.name), bytes, error);
+    }
+
+    // Writes already-encoded bytes with the temp-file-and-rename dance
+    bool write(const std::string& path, const std::string& bytes, std::string& error) const {
+        if (!enabled()) return true;
+        std::error_code ec;
+        std::filesystem::create_directories(dir, ec);
+        return replaceFile(path, bytes, error);
+    }
+
+private:
+    std::string dir;
+};
+
+//------Background saving-------//
+// The game thread encodes a snapshot (a few dozen bytes) and hands it over;
+// the disk work happens on the saver's thread. Only the newest snapshot per
+// profile is kept, so a slow disk skips stale saves instead of queueing them.
+// Everything handed over is written before the destructor returns.
+class ProfileSaver {
+public:
+    explicit ProfileSaver(const ProfileStore& store) : store(store), worker([this]() { run(); }) {}
+
+    ~ProfileSaver() {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            stopping = true;
+        }
+        cv.notify_one();
+        worker.join();
+    }
+
+    ProfileSaver(const ProfileSaver&) = delete;
+    ProfileSaver& operator=(const ProfileSaver&) = delete;
+
+    void submit(const ProfileSnapshot& s) {
+        if (!store.enabled()) return;
+        std::string path = store.pathFor(s.name);
+        std::string bytes;
+        encodeProfile(s, bytes);
+        {
+            std::lock_guard<std::mutex> lock(m);
+            pending[std::move(path)].swap(bytes);
+        }
+        cv.notify_one();
+    }
+
+    // The last save failure since the previous call, if any
+    bool takeError(std::string& error) {
+        std::lock_guard<std::mutex> lock(m);
+        if (failure.empty()) return false;
+        error.swap(failure);
+        failure.clear();
+        return true;
+    }
+
+private:
+    const ProfileStore& store;
+    std::mutex m;
+    std::condition_variable cv;
+    std::unordered_map<std::string, std::string> pending; // path -> newest encoded snapshot
+    std::string failure;
+    bool stopping = false;
+    std::thread worker;
+
+    void run() {
+        std::unique_lock<std::mutex> lock(m);
+        for (;;) {
+            cv.wait(lock, [this]() { return stopping || !pending.empty(); });
+            if (pending.empty()) return; // stopping, nothing left
+            std::unordered_map<std::string, std::string> batch;
+            batch.swap(pending);
+            lock.unlock();
+            // One failed write (a full disk, a bad name) must not cost the
+            // other profiles in the batch their saves; the first error is kept
+            std::string error, first;
+            for (const auto& job : batch) {
+                if (!store.write(job.first, job.second, error) && first.empty()) first = error;
+            }
+            lock.lock();
+            if (!first.empty()) failure = first;
+        }
+    }
+};
+
+//------One connection per profile-------//
+// Names with a visit in progress on this server, so two connections never
+// play (and save over) the same profile at once
+class ProfileClaims {
+public:
+    bool claim(const std::string& name) {
+        std::lock_guard<std::mutex> lock(m);
+        return names.insert(name).second;
+    }
+    void release(const std::string& name) {
+        std::lock_guard<std::mutex> lock(m);
+        names.erase(name);
+    }
+
+private:
+    std::mutex m;
+    std::set<std::string> names;
+};
+
+// Holds one name for as long as it lives; with no claims (the console) every name is free
+class ProfileClaim {
+public:
+    explicit ProfileClaim(ProfileClaims* claims = nullptr) : claims(claims) {}
+    ~ProfileClaim() {
+        if (claims && held) claims->release(name);
+    }
+    ProfileClaim(const ProfileClaim&) = delete;
+    ProfileClaim& operator=(const ProfileClaim&) = delete;
+
+    bool take(const std::string& wanted) {
+        if (claims && !claims->claim(wanted)) return false;
+        name = wanted;
+        held = true;
+        return true;
+    }
+
+private:
+    ProfileClaims* claims;
+    std::string name;
+    bool held = false;
+};
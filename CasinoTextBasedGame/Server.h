@@ -0,0 +1,479 @@
+﻿#pragma once
+#include "Main.h"
+#ifndef _WIN32
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+//================== Casino Server ==================//
+// --serve <socket> hosts any number of independent visits to the casino over
+// a Unix domain socket, each with its own Player, CasinoManager, tables and
+// random generator. The protocol is the one a pipe already speaks: the
+// client sends answer lines (a key prompt takes the first non-blank
+// character, an empty line is Enter) and the server sends back plain text,
+// prompts included, exactly as a piped console would show it.
+//
+// Sessions run on a fixed pool of worker threads. A visit is one coroutine
+// (Coroutine.h): when a prompt finds no answer waiting, it suspends on the
+// worker's event loop until the client's next line arrives, and costs only
+// its coroutine frames while it waits. A session stays on the worker that
+// accepted it; the loop switches the output capture, terminal and generator
+// to the session's own each time it resumes one. POSIX only: the socket is
+// AF_UNIX.
+
+//------A connected player-------//
+struct ServerSession;
+
+// Answers come from the session's socket, one line per prompt; waiting for
+// a line suspends the session
+class SocketInput : public InputSource {
+public:
+    static constexpr size_t maxLine = 4096; // a longer line drops the connection
+    static constexpr int turnLines = 32;    // answers per turn before other sessions get theirs
+
+    explicit SocketInput(ServerSession& session) : session(session) {}
+
+    Task<Action> key(const Prompt& prompt) override;
+    Task<bool> number(const Prompt& prompt, double& value) override;
+    Task<bool> text(const Prompt& prompt, std::string& line) override;
+    Task<bool> pause(const Prompt& prompt) override;
+
+private:
+    ServerSession& session;
+
+    void show(std::string_view text);
+    Task<bool> nextLine(std::string& line);
+};
+
+struct ServerSession {
+    const int fd;
+    std::string in;      // received, not yet answered
+    std::string out;     // to send
+    size_t sent = 0;     // bytes of `out` already sent
+    bool closed = false; // client hung up, or the server is stopping
+    int turn = 0;        // lines answered since the session last waited
+    Terminal term{ false };
+    std::mt19937 gen;
+    SocketInput input{ *this };
+    Task<void> visit;    // the whole session; done once it has said goodbye
+
+    ServerSession(int fd, uint32_t seed) : fd(fd), gen(seed) {}
+
+    SessionContext context() { return SessionContext{ &out, &term, &gen, fd }; }
+    bool hasLine() const { return in.find('\n') != std::string::npos; }
+    bool pending() const { return sent < out.size(); }
+
+    // Sends what the socket takes now; false if the client is gone
+    bool flush() {
+        while (sent < out.size()) {
+            const ssize_t n = ::send(fd, out.data() + sent, out.size() - sent, 0);
+            if (n > 0) sent += static_cast<size_t>(n);
+            else if (n < 0 && errno == EINTR) continue;
+            else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+            else {
+                closed = true;
+                out.clear();
+                sent = 0;
+                return false;
+            }
+        }
+        out.clear();
+        sent = 0;
+        return true;
+    }
+
+    // Reads everything waiting; marks the session closed at end of stream
+    void receive() {
+        char buffer[4096];
+        for (;;) {
+            const ssize_t n = ::recv(fd, buffer, sizeof buffer, 0);
+            if (n > 0) in.append(buffer, static_cast<size_t>(n));
+            else if (n < 0 && errno == EINTR) continue;
+            else {
+                if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) closed = true;
+                return;
+            }
+        }
+    }
+};
+
+inline Task<Action> SocketInput::key(const Prompt& prompt) {
+    std::string line;
+    for (;;) {
+        show(prompt.text);
+        const bool got = co_await nextLine(line);
+        if (!got) co_return Action::None;
+        const auto at = line.find_first_not_of(" \t");
+        const int k = at == std::string::npos ? '\n' : static_cast<unsigned char>(line[at]);
+        const Action action = (*prompt.keys)[k];
+        if (action != Action::None) co_return action;
+    }
+}
+
+inline Task<bool> SocketInput::number(const Prompt& prompt, double& value) {
+    std::string line;
+    for (;;) {
+        show(prompt.text);
+        const bool got = co_await nextLine(line);
+        if (!got) co_return false;
+        const Parse result = parseNumber(line, prompt, value);
+        if (result == Parse::Ok) co_return true;
+        std::ostringstream why;
+        describeParseError(why, result, prompt);
+        show(why.str());
+    }
+}
+
+inline Task<bool> SocketInput::text(const Prompt& prompt, std::string& line) {
+    show(prompt.text);
+    co_return co_await nextLine(line);
+}
+
+inline Task<bool> SocketInput::pause(const Prompt& prompt) {
+    std::string line;
+    show(prompt.text);
+    co_return co_await nextLine(line);
+}
+
+inline void SocketInput::show(std::string_view text) { session.out.append(text.data(), text.size()); }
+
+inline Task<bool> SocketInput::nextLine(std::string& line) {
+    // The frame buffer is the worker's, so whatever is composed goes out before any wait
+    EventLoop& loop = eventLoop();
+    // A client that sends a whole script at once still shares its worker
+    if (++session.turn > turnLines) {
+        frame().present();
+        session.turn = 0;
+        co_await loop.yield();
+    }
+    while (!session.hasLine()) {
+        if (session.closed || session.in.size() > maxLine) co_return false;
+        frame().present();
+        session.turn = 0;
+        if (!session.flush()) co_return false;
+        const short events = co_await loop.ready(session.fd, static_cast<short>(POLLIN | (session.pending() ? POLLOUT : 0)));
+        if (events & POLLOUT) session.flush();
+        if (events & (POLLIN | POLLHUP | POLLERR)) session.receive();
+    }
+    const size_t end = session.in.find('\n');
+    line.assign(session.in, 0, end);
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    session.in.erase(0, end + 1);
+    co_return true;
+}
+
+//------Workers-------//
+// One thread and one event loop for all of its sessions. New connections
+// arrive through a pipe the loop also watches. A session's output is sent
+// without blocking whenever it waits; whatever the socket does not take is
+// sent as POLLOUT allows.
+class ServerWorker {
+public:
+    using Visit = std::function<Task<void>(InputSource&)>;
+
+    explicit ServerWorker(const Visit& visit) : visit(visit) {
+        if (pipe(wake) == 0) {
+            fcntl(wake[0], F_SETFL, O_NONBLOCK);
+            fcntl(wake[1], F_SETFL, O_NONBLOCK);
+        }
+        thread = std::thread([this]() { run(); });
+    }
+
+    ~ServerWorker() {
+        stop();
+        if (thread.joinable()) thread.join();
+        ::close(wake[0]);
+        ::close(wake[1]);
+    }
+
+    ServerWorker(const ServerWorker&) = delete;
+    ServerWorker& operator=(const ServerWorker&) = delete;
+
+    // Takes over a connected socket
+    void adopt(int fd) {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            incoming.push_back(fd);
+        }
+        live.fetch_add(1, std::memory_order_relaxed);
+        notify();
+    }
+
+    // Ends every session as if its client had left, then the thread
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            stopping = true;
+        }
+        notify();
+    }
+
+    size_t sessionCount() const { return live.load(std::memory_order_relaxed); }
+
+private:
+    const Visit& visit;
+    int wake[2] = { -1, -1 };
+    std::mutex m;
+    std::vector<int> incoming;
+    bool stopping = false;
+    std::atomic<size_t> live{ 0 };
+    std::vector<std::unique_ptr<ServerSession>> sessions;
+    size_t ended = 0;    // sessions whose visit is done, not yet closed
+    bool ending = false; // seen `stopping`
+
+    std::thread thread;
+
+    void notify() {
+        const char byte = 1;
+        (void)!::write(wake[1], &byte, 1);
+    }
+
+    // The visit, then its last words; a visit that fails ends only its own session
+    Task<void> runSession(ServerSession& s) {
+        try {
+            co_await visit(s.input);
+        }
+        catch (const SessionClosed&) {
+        }
+        catch (const std::exception& e) {
+            s.out += std::string("\n[!] Session ended: ") + e.what() + "\n";
+        }
+        catch (...) {
+        }
+        frame().present();
+        while (!s.closed && s.flush() && s.pending()) {
+            const short events = co_await eventLoop().ready(s.fd, POLLOUT);
+            if (!events) break; // woken: the server is stopping
+        }
+        ++ended;
+    }
+
+    void start(int fd) {
+        std::random_device seeder;
+        auto session = std::make_unique<ServerSession>(fd, seeder());
+        ServerSession& s = *session;
+        sessions.push_back(std::move(session));
+        s.visit = runSession(s);
+
+        // Runs up to the first prompt in the session's own context
+        const SessionContext outer = sessionContext();
+        sessionContext() = s.context();
+        s.visit.start();
+        sessionContext() = outer;
+    }
+
+    // New connections and the stop request both come through the pipe
+    Task<void> watchPipe() {
+        EventLoop& loop = eventLoop();
+        while (!ending) {
+            co_await loop.ready(wake[0], POLLIN);
+            char drain[64];
+            while (::read(wake[0], drain, sizeof drain) > 0) {}
+            std::vector<int> arrived;
+            {
+                std::lock_guard<std::mutex> lock(m);
+                arrived.swap(incoming);
+                ending = stopping;
+            }
+            for (int fd : arrived) start(fd);
+        }
+        for (auto& s : sessions) {
+            s->closed = true;
+            loop.wake(s->fd);
+        }
+    }
+
+    // Closes the sockets of finished sessions and frees them
+    void reap() {
+        for (size_t i = 0; i < sessions.size() && ended > 0;) {
+            ServerSession& s = *sessions[i];
+            if (s.visit.done()) {
+                ::close(s.fd);
+                sessions[i] = std::move(sessions.back());
+                sessions.pop_back();
+                --ended;
+                live.fetch_sub(1, std::memory_order_relaxed);
+            }
+            else ++i;
+        }
+    }
+
+    void run() {
+        inputEndsSession() = true;
+        EventLoop& loop = eventLoop();
+        Task<void> watcher = watchPipe();
+        watcher.start();
+        while (!(ending && sessions.empty())) {
+            loop.runOnce();
+            if (ended) reap();
+        }
+    }
+};
+
+//------Listener-------//
+class CasinoServer {
+public:
+    using Visit = ServerWorker::Visit;
+
+    // `visit` plays one whole visit to the casino against the given input
+    CasinoServer(std::string socketPath, unsigned threads, Visit visit)
+        : path(std::move(socketPath)), threadCount(threads ? threads : std::max(1u, std::thread::hardware_concurrency())), visit(std::move(visit)) {}
+
+    ~CasinoServer() {
+        workers.clear();
+        if (listener >= 0) {
+            ::close(listener);
+            ::unlink(path.c_str());
+        }
+    }
+
+    CasinoServer(const CasinoServer&) = delete;
+    CasinoServer& operator=(const CasinoServer&) = delete;
+
+    unsigned threads() const { return threadCount; }
+
+    // Binds the socket (replacing a stale one left by a previous server) and starts the workers
+    bool listen(std::string& error) {
+        sockaddr_un addr{};
+        if (path.size() >= sizeof addr.sun_path) {
+            error = "Socket path is too long: " + path;
+            return false;
+        }
+        struct stat st;
+        if (::lstat(path.c_str(), &st) == 0) {
+            if (!S_ISSOCK(st.st_mode)) {
+                error = path + " exists and is not a socket";
+                return false;
+            }
+            ::unlink(path.c_str());
+        }
+        listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+        if (listener < 0 || ::bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof addr) != 0 || ::listen(listener, SOMAXCONN) != 0) {
+            error = "Cannot listen on " + path + ": " + std::strerror(errno);
+            if (listener >= 0) ::close(listener);
+            listener = -1;
+            return false;
+        }
+        fcntl(listener, F_SETFD, FD_CLOEXEC);
+
+        // Thousands of players need thousands of descriptors
+        rlimit files{};
+        if (getrlimit(RLIMIT_NOFILE, &files) == 0 && files.rlim_cur < files.rlim_max) {
+            files.rlim_cur = files.rlim_max;
+            setrlimit(RLIMIT_NOFILE, &files);
+        }
+        std::signal(SIGPIPE, SIG_IGN);
+        for (unsigned i = 0; i < threadCount; ++i) workers.push_back(std::make_unique<ServerWorker>(this->visit));
+        return true;
+    }
+
+    // Accepts until SIGINT or SIGTERM; each connection goes to the least busy worker
+    void run() {
+        if (pipe(stopPipe()) != 0) return;
+        fcntl(stopPipe()[1], F_SETFL, O_NONBLOCK);
+        struct sigaction sa {};
+        sa.sa_handler = [](int) { (void)!::write(stopPipe()[1], "x", 1); };
+        sigemptyset(&sa.sa_mask);
+        sigaction(SIGINT, &sa, nullptr);
+        sigaction(SIGTERM, &sa, nullptr);
+
+        pollfd fds[2] = { { listener, POLLIN, 0 }, { stopPipe()[0], POLLIN, 0 } };
+        while (!fds[1].revents) {
+            if (poll(fds, 2, -1) < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            if (!(fds[0].revents & POLLIN)) continue;
+            const int fd = ::accept(listener, nullptr, nullptr);
+            if (fd < 0) continue;
+            fcntl(fd, F_SETFL, O_NONBLOCK);
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+            ServerWorker* least = workers.front().get();
+            for (const auto& w : workers) {
+                if (w->sessionCount() < least->sessionCount()) least = w.get();
+            }
+            least->adopt(fd);
+        }
+        for (auto& w : workers) w->stop();
+        workers.clear();
+    }
+
+private:
+    const std::string path;
+    const unsigned threadCount;
+    const Visit visit;
+    int listener = -1;
+    std::vector<std::unique_ptr<ServerWorker>> workers;
+
+    static int* stopPipe() {
+        static int fds[2] = { -1, -1 };
+        return fds;
+    }
+};
+
+//------Client-------//
+// --connect <socket>: typed lines go to the server and everything it sends is
+// printed as it arrives. Returns the process exit code.
+inline int runCasinoClient(const std::string& path) {
+    sockaddr_un addr{};
+    if (path.size() >= sizeof addr.sun_path) {
+        drawAsciiBox("Socket path is too long: " + path);
+        return 1;
+    }
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) != 0) {
+        drawAsciiBox("Cannot connect to " + path + ": " + std::strerror(errno));
+        if (fd >= 0) ::close(fd);
+        return 1;
+    }
+    std::signal(SIGPIPE, SIG_IGN);
+
+    pollfd fds[2] = { { fd, POLLIN, 0 }, { STDIN_FILENO, POLLIN, 0 } };
+    char buffer[4096];
+    for (;;) {
+        if (poll(fds, fds[1].fd < 0 ? 1 : 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[0].revents) {
+            const ssize_t n = ::recv(fd, buffer, sizeof buffer, 0);
+            if (n <= 0) break; // the server closed the session
+            FrameBuffer& out = frame();
+            out << std::string_view(buffer, static_cast<size_t>(n));
+            out.present();
+        }
+        if (fds[1].fd >= 0 && fds[1].revents) {
+            const ssize_t n = ::read(STDIN_FILENO, buffer, sizeof buffer);
+            if (n <= 0) { // no more typing; keep reading until the server is done
+                ::shutdown(fd, SHUT_WR);
+                fds[1].fd = -1;
+                continue;
+            }
+            for (ssize_t sent = 0; sent < n;) {
+                const ssize_t w = ::send(fd, buffer + sent, static_cast<size_t>(n - sent), 0);
+                if (w <= 0) break;
+                sent += w;
+            }
+        }
+    }
+    ::close(fd);
+    return 0;
+}
+#endif
@@ -0,0 +1,1059 @@
+﻿#pragma once
+#include "Main.h"
+#include "BaccaratEngine.h"
+#include "BaccaratRoads.h"
+#include "BlackjackRules.h"
+#include "GameRegistry.h"
+#include "Games.h"
+#include "HighLow.h"
+#include "JobScheduler.h"
+#include "Poker.h"
+#include "SaveGame.h"
+#include "SlotsEngine.h"
+#include "VideoSlotsEngine.h"
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+
+//================== Offline Simulator ==================//
+//------Command-line entry: CasinoTextBasedGame --simulate <game> [rounds|shoes] [seed] [slots config] [--jobs n] [--metrics] [--trace file]-------//
+// The engines split their rounds into chunks on the job scheduler (JobScheduler.h),
+// each seeded from its index, so a seed gives the same figures at any --jobs.
+
+template <typename Rules>
+void reportBlackjackVariant(std::ostringstream& oss, uint64_t rounds, uint32_t seed) {
+    auto start = std::chrono::steady_clock::now();
+    BlackjackSimResult r = simulateBlackjack<Rules>(rounds, seed);
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    oss << Rules::name << "\n";
+    oss << std::fixed << std::setprecision(3)
+        << "  RTP " << r.rtp() * 100.0 << "%  edge " << r.houseEdge() * 100.0 << "%"
+        << "  BJ " << r.blackjacks << "  dbl " << r.doubles << "  sur " << r.surrenders << "\n";
+    oss << std::setprecision(1) << "  " << (secs > 0.0 ? r.rounds / secs / 1e6 : 0.0) << "M rounds/s\n";
+}
+
+void simulateBlackjackVariants(uint64_t rounds, uint32_t seed) {
+    std::ostringstream oss;
+    oss << "BLACKJACK SIMULATION (" << rounds << " rounds per variant, " << jobScheduler().threads() << " threads)\n\n";
+    reportBlackjackVariant<ClassicRules>(oss, rounds, seed);
+    reportBlackjackVariant<VegasStripRules>(oss, rounds, seed);
+    reportBlackjackVariant<DowntownRules>(oss, rounds, seed);
+    reportBlackjackVariant<SixToFiveRules>(oss, rounds, seed);
+    drawAsciiBox(oss.str());
+}
+
+// Deals real 8-deck shoes to the cut card and prices every coup exactly from the
+// remaining composition, to audit the 8x tie payout against live shoe states.
+void auditBaccaratShoes(uint64_t shoes, uint32_t seed) {
+    const int decks = 8;
+    const int cutCard = 16;
+    JobScheduler& jobs = jobScheduler();
+    std::vector<BaccaratOddsEngine> engines(jobs.threads()); // one odds cache per participant
+
+    std::vector<uint8_t> deck;
+    for (int v = 0; v < 10; ++v)
+        deck.insert(deck.end(), static_cast<size_t>(BaccaratShoe::full(decks).counts[v]), static_cast<uint8_t>(v));
+
+    struct Audit {
+        uint64_t coups = 0, positiveTie = 0;
+        uint64_t results[3] = { 0, 0, 0 };
+        double sumTieEV = 0.0, bestTieEV = -1.0, worstTieEV = 1.0;
+    };
+    auto start = std::chrono::steady_clock::now();
+
+    // One shoe per job: shoes that keep missing the cache cost far more than the rest
+    const Audit a = jobs.parallelReduce(shoes, 1, Audit(),
+        [&](const JobScheduler::Slice& s) {
+            BaccaratOddsEngine& engine = engines[s.worker];
+            std::mt19937 gen(s.seed(seed));
+            std::vector<uint8_t> cards = deck;
+            std::shuffle(cards.begin(), cards.end(), gen);
+            BaccaratShoe shoe = BaccaratShoe::full(decks);
+            Audit part;
+            size_t pos = 0;
+            while (cards.size() - pos >= static_cast<size_t>(cutCard)) {
+                const BaccaratOdds& o = engine.query(shoe);
+                part.sumTieEV += o.evTie;
+                part.bestTieEV = std::max(part.bestTieEV, o.evTie);
+                part.worstTieEV = std::min(part.worstTieEV, o.evTie);
+                if (o.evTie > 0.0) ++part.positiveTie;
+
+                BaccaratCoup c = resolveBaccaratCoup(&cards[pos]);
+                for (int i = 0; i < c.cardsUsed; ++i) shoe.remove(cards[pos + i]);
+                pos += static_cast<size_t>(c.cardsUsed);
+                part.results[c.winner]++;
+                ++part.coups;
+            }
+            return part;
+        },
+        [](Audit& t, const Audit& p) {
+            t.coups += p.coups;
+            t.positiveTie += p.positiveTie;
+            for (int i = 0; i < 3; ++i) t.results[i] += p.results[i];
+            t.sumTieEV += p.sumTieEV;
+            t.bestTieEV = std::max(t.bestTieEV, p.bestTieEV);
+            t.worstTieEV = std::min(t.worstTieEV, p.worstTieEV);
+        });
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    BaccaratOddsEngine& engine = engines[0];
+    uint64_t cacheHits = 0, cacheMisses = 0;
+    for (const BaccaratOddsEngine& e : engines) { cacheHits += e.cacheHits(); cacheMisses += e.cacheMisses(); }
+    const BaccaratOdds& fresh = engine.query(BaccaratShoe::full(decks));
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(4);
+    oss << "BACCARAT TIE AUDIT (" << shoes << " shoes, " << a.coups << " coups, " << jobs.threads() << " threads)\n\n";
+    oss << "Fresh shoe: P " << fresh.player * 100 << "%  B " << fresh.banker * 100 << "%  T " << fresh.tie * 100 << "%\n";
+    oss << "Fresh shoe tie EV at " << engine.payoutTable().tie << "x: " << fresh.evTie * 100 << "%\n\n";
+    oss << "Mean tie EV over dealt states: " << (a.coups ? a.sumTieEV / a.coups * 100 : 0.0) << "%\n";
+    oss << "Best / worst state: " << a.bestTieEV * 100 << "% / " << a.worstTieEV * 100 << "%\n";
+    oss << "States with positive tie EV: " << a.positiveTie << "\n";
+    oss << "Observed P/B/T: " << a.results[0] << " / " << a.results[1] << " / " << a.results[2] << "\n";
+    oss << std::setprecision(2) << "Odds cache hits " << cacheHits << ", misses " << cacheMisses
+        << ", " << secs << "s";
+    drawAsciiBox(oss.str());
+}
+
+// Runs many independent 8-deck shoes side by side through the batched coup kernel.
+// Each job deals its own rack of shoes; the first batches of the first job are
+// cross-checked against the scalar resolveBaccaratCoup.
+void simulateBaccaratKernel(uint64_t coups, uint32_t seed) {
+    const size_t lanes = 1024;
+    const size_t shoeCards = 416;
+    const size_t cutCard = 16;
+    const uint64_t batchesPerJob = 1024;
+    JobScheduler& jobs = jobScheduler();
+
+    struct Kernel {
+        uint64_t done = 0, mismatches = 0, shoesDealt = 0;
+        uint64_t results[3] = { 0, 0, 0 };
+        double kernelSecs = 0.0;
+    };
+    auto start = std::chrono::steady_clock::now();
+
+    const uint64_t batchCount = (coups + lanes - 1) / lanes;
+    const Kernel sum = jobs.parallelReduce(batchCount, batchesPerJob, Kernel(),
+        [&](const JobScheduler::Slice& s) {
+            Kernel part;
+            std::mt19937 gen(s.seed(seed));
+            std::vector<uint8_t> shoes(lanes * shoeCards);
+            std::vector<uint16_t> pos(lanes, 0);
+            for (size_t l = 0; l < lanes; ++l) {
+                uint8_t* shoe = &shoes[l * shoeCards];
+                for (size_t i = 0; i < shoeCards; ++i) shoe[i] = static_cast<uint8_t>((i % 13) + 1 >= 10 ? 0 : (i % 13) + 1);
+                std::shuffle(shoe, shoe + shoeCards, gen);
+            }
+            part.shoesDealt = lanes;
+
+            std::vector<uint8_t> soa(6 * lanes), winner(lanes), pp(lanes), bp(lanes), used(lanes);
+            BaccaratBatch batch{ { &soa[0], &soa[lanes], &soa[2 * lanes], &soa[3 * lanes], &soa[4 * lanes], &soa[5 * lanes] },
+                                 winner.data(), pp.data(), bp.data(), used.data() };
+
+            for (uint64_t b = 0; b < s.size(); ++b) {
+                for (size_t l = 0; l < lanes; ++l) {
+                    const uint8_t* next = &shoes[l * shoeCards + pos[l]];
+                    for (size_t k = 0; k < 6; ++k) soa[k * lanes + l] = next[k];
+                }
+
+                auto k0 = std::chrono::steady_clock::now();
+                resolveBaccaratBatch(batch, lanes);
+                part.kernelSecs += std::chrono::duration<double>(std::chrono::steady_clock::now() - k0).count();
+
+                for (size_t l = 0; l < lanes; ++l) {
+                    if (s.index == 0 && b < 64) {
+                        BaccaratCoup ref = resolveBaccaratCoup(&shoes[l * shoeCards + pos[l]]);
+                        if (ref.winner != winner[l] || ref.playerPoints != pp[l] || ref.bankerPoints != bp[l] || ref.cardsUsed != used[l])
+                            ++part.mismatches;
+                    }
+                    part.results[winner[l]]++;
+                    pos[l] = static_cast<uint16_t>(pos[l] + used[l]);
+                    if (shoeCards - pos[l] < cutCard) {
+                        std::shuffle(&shoes[l * shoeCards], &shoes[l * shoeCards] + shoeCards, gen);
+                        pos[l] = 0;
+                        ++part.shoesDealt;
+                    }
+                }
+                part.done += lanes;
+            }
+            return part;
+        },
+        [](Kernel& t, const Kernel& p) {
+            t.done += p.done;
+            t.mismatches += p.mismatches;
+            t.shoesDealt += p.shoesDealt;
+            for (int i = 0; i < 3; ++i) t.results[i] += p.results[i];
+            t.kernelSecs += p.kernelSecs;
+        });
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(4);
+    oss << "BACCARAT KERNEL (" << sum.done << " coups, " << lanes << " shoes in flight per job, " << jobs.threads() << " threads)\n\n";
+#ifdef CASINO_BACCARAT_SIMD
+    oss << "Kernel path: SSSE3, 16 lanes per step\n";
+#else
+    oss << "Kernel path: scalar (build with SSSE3/AVX for SIMD lanes)\n";
+#endif
+    oss << "Player " << 100.0 * sum.results[0] / sum.done << "%  Banker " << 100.0 * sum.results[1] / sum.done
+        << "%  Tie " << 100.0 * sum.results[2] / sum.done << "%\n";
+    oss << "Shoes dealt: " << sum.shoesDealt << "  reference mismatches: " << sum.mismatches << "\n";
+    oss << std::setprecision(1);
+    oss << "Kernel: " << (sum.kernelSecs > 0.0 ? sum.done / sum.kernelSecs / 1e6 : 0.0) << "M coups/s per thread\n";
+    oss << "End to end (gather + shuffle): " << (secs > 0.0 ? sum.done / secs / 1e6 : 0.0) << "M coups/s";
+    drawAsciiBox(oss.str());
+}
+
+// Feeds simulated coups into the scoreboard roads and prints the last shoe.
+// Pairs are judged by baccarat value here, since the sim shoe holds values only.
+// Every shoe starts a fresh scoreboard, so jobs deal their own shoes side by side.
+void simulateBaccaratRoads(uint64_t coups, uint32_t seed) {
+    const size_t shoeCards = 416;
+    const size_t cutCard = 16;
+    const uint64_t coupsPerJob = 1u << 16;
+    JobScheduler& jobs = jobScheduler();
+    const uint64_t lastJob = JobScheduler::chunks(coups, coupsPerJob) - 1;
+    BaccaratScoreboard last;
+
+    struct Roads {
+        uint64_t done = 0, shoes = 0;
+        double recordSecs = 0.0;
+    };
+    const Roads sum = jobs.parallelReduce(coups, coupsPerJob, Roads(),
+        [&](const JobScheduler::Slice& s) {
+            std::mt19937 gen(s.seed(seed));
+            std::vector<uint8_t> shoe(shoeCards);
+            for (size_t i = 0; i < shoeCards; ++i) shoe[i] = static_cast<uint8_t>((i % 13) + 1 >= 10 ? 0 : (i % 13) + 1);
+
+            BaccaratScoreboard board;
+            std::vector<BaccaratCoup> coupsBuf;
+            std::vector<uint8_t> pairs;
+            Roads part;
+
+            while (part.done < s.size()) {
+                // Resolve a whole shoe first so the timing below covers record() only
+                std::shuffle(shoe.begin(), shoe.end(), gen);
+                coupsBuf.clear();
+                pairs.clear();
+                for (size_t pos = 0; shoe.size() - pos >= cutCard && part.done + coupsBuf.size() < s.size();) {
+                    BaccaratCoup c = resolveBaccaratCoup(&shoe[pos]);
+                    pairs.push_back(static_cast<uint8_t>((shoe[pos] == shoe[pos + 2]) | ((shoe[pos + 1] == shoe[pos + 3]) << 1)));
+                    coupsBuf.push_back(c);
+                    pos += static_cast<size_t>(c.cardsUsed);
+                }
+
+                auto t0 = std::chrono::steady_clock::now();
+                board.newShoe();
+                for (size_t i = 0; i < coupsBuf.size(); ++i) {
+                    const BaccaratCoup& c = coupsBuf[i];
+                    board.record(c.winner, pairs[i] & 1, (pairs[i] >> 1) & 1, c.cardsUsed == 4 && (c.playerPoints >= 8 || c.bankerPoints >= 8),
+                        c.playerPoints, c.bankerPoints);
+                }
+                part.recordSecs += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+                part.done += coupsBuf.size();
+                ++part.shoes;
+            }
+            if (s.index == lastJob) last = board;
+            return part;
+        },
+        [](Roads& t, const Roads& p) {
+            t.done += p.done;
+            t.shoes += p.shoes;
+            t.recordSecs += p.recordSecs;
+        });
+
+    last.show();
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1);
+    oss << "SCOREBOARD ROADS (" << sum.done << " coups, " << sum.shoes << " shoes, " << jobs.threads() << " threads)\n";
+    oss << "record(): " << (sum.done ? sum.recordSecs * 1e9 / sum.done : 0.0) << " ns per coup, "
+        << sizeof(BaccaratScoreboard) << " bytes per scoreboard";
+    drawAsciiBox(oss.str());
+}
+
+// Histogram-driven bot, with and without reshuffling between rounds
+void simulateHighLow(uint64_t rounds, uint32_t seed) {
+    std::ostringstream oss;
+    oss << std::fixed;
+    oss << "HIGH-LOW BOT (" << rounds << " rounds per mode, " << jobScheduler().threads() << " threads)\n\n";
+    for (int persistent = 0; persistent <= 1; ++persistent) {
+        auto start = std::chrono::steady_clock::now();
+        HighLowSimResult r = simulateHighLowBot(rounds, seed, persistent != 0);
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        oss << (persistent ? "Same deck between rounds" : "Reshuffle every round") << "\n";
+        oss << std::setprecision(3) << "  RTP " << r.rtp() * 100.0 << "%  W/L/T " << r.wins << "/" << r.losses << "/" << r.ties << "\n";
+        oss << std::setprecision(1) << "  " << (secs > 0.0 ? r.rounds / secs / 1e6 : 0.0) << "M rounds/s\n";
+    }
+    drawAsciiBox(oss.str());
+}
+
+// One ladder under solver advice, dealing from cards[pos...]; returns the payout per unit bet
+double playOptimalLadder(HighLowLadderSolver& solver, RankHistogram& hist, const uint8_t* cards, int pos) {
+    int cur = cards[pos++];
+    hist.remove(cur);
+    for (int rung = 0;; ) {
+        HighLowLadderSolver::Advice a;
+        solver.advise(hist, cur, rung, a); // one deck: always fits
+        if (a.takeCash) return a.cashOut;
+        const int next = cards[pos++];
+        hist.remove(next);
+        if (!((next > cur && a.guess == 'H') || (next < cur && a.guess == 'L'))) return 0.0;
+        cur = next;
+        if (++rung == HighLowLadderSolver::rungs) return solver.paytable()[rung];
+    }
+}
+
+// Certifies the ladder RTP exhaustively, then plays optimal ladders from one
+// persistent deck to time live hints and cross-check the exact figure.
+void simulateHighLowLadder(uint64_t ladders, uint32_t seed) {
+    HighLowLadderSolver certify;
+    auto start = std::chrono::steady_clock::now();
+    const double rtp = certify.exactRtp();
+    const double certifyMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    const size_t states = certify.memoSize();
+
+    // Monte Carlo on fresh decks should land on the certified figure; every state
+    // is already memoised, so these cost a few lookups each. The solver writes its
+    // table as it goes, so each participant works on its own copy.
+    const uint64_t freshLadders = ladders * 100;
+    JobScheduler& jobs = jobScheduler();
+    std::vector<HighLowLadderSolver> solvers(jobs.threads(), certify);
+    uint8_t cards[52];
+    for (int i = 0; i < 52; ++i) cards[i] = static_cast<uint8_t>(Card::Two + i % 13);
+    RankHistogram hist;
+    const double freshReturned = jobs.parallelReduce(freshLadders, 1u << 14, 0.0,
+        [&](const JobScheduler::Slice& s) {
+            std::mt19937 gen(s.seed(seed));
+            uint8_t deck[52];
+            std::copy(cards, cards + 52, deck);
+            RankHistogram h;
+            double returned = 0.0;
+            for (uint64_t i = 0; i < s.size(); ++i) {
+                std::shuffle(deck, deck + 52, gen);
+                h.fill();
+                returned += playOptimalLadder(solvers[s.worker], h, deck, 0);
+            }
+            return returned;
+        },
+        [](double& t, double p) { t += p; });
+
+    // Live hints are timed one after another from a single deck. As in the
+    // game, the memo lives as long as the deck and is warmed between ladders;
+    // the warm-ups are timed apart from the hints.
+    std::mt19937 gen(seed);
+    HighLowLadderSolver live;
+    std::shuffle(cards, cards + 52, gen);
+    hist.fill();
+    int pos = 0;
+
+    double returned = 0.0, worstMs = 0.0, totalMs = 0.0, warmMs = 0.0, worstWarmMs = 0.0;
+    uint64_t queries = 0;
+    for (uint64_t i = 0; i < ladders; ++i) {
+        if (52 - pos < HighLowLadderSolver::rungs + 1) {
+            std::shuffle(cards, cards + 52, gen);
+            hist.fill();
+            pos = 0;
+            live.clear();
+        }
+        const auto w0 = std::chrono::steady_clock::now();
+        live.warm(hist);
+        const double wms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - w0).count();
+        warmMs += wms;
+        worstWarmMs = std::max(worstWarmMs, wms);
+
+        int cur = cards[pos++];
+        hist.remove(cur);
+        for (int rung = 0;; ) {
+            auto q0 = std::chrono::steady_clock::now();
+            HighLowLadderSolver::Advice a;
+            live.advise(hist, cur, rung, a);
+            const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - q0).count();
+            totalMs += ms;
+            worstMs = std::max(worstMs, ms);
+            ++queries;
+
+            if (a.takeCash) { returned += a.cashOut; break; }
+            const int next = cards[pos++];
+            hist.remove(next);
+            if (!((next > cur && a.guess == 'H') || (next < cur && a.guess == 'L'))) break;
+            cur = next;
+            if (++rung == HighLowLadderSolver::rungs) { returned += live.paytable()[rung]; break; }
+        }
+    }
+
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(4);
+    oss << "HIGH-LOW LADDER (" << HighLowLadderSolver::rungs << " rungs)\n\n";
+    oss << "Exact RTP, fresh deck, optimal play: " << rtp * 100.0 << "%\n";
+    oss << std::setprecision(2) << "Certified in " << certifyMs << " ms over " << states << " memoised states\n";
+    oss << std::setprecision(4) << "Monte Carlo, " << freshLadders << " fresh decks: " << (freshLadders ? freshReturned / freshLadders * 100.0 : 0.0) << "%\n\n";
+    oss << std::setprecision(4) << "Played " << ladders << " ladders from one persistent deck\n";
+    oss << "Realised RTP: " << (ladders ? returned / ladders * 100.0 : 0.0) << "%\n";
+    oss << std::setprecision(3) << "Hint latency: mean " << (queries ? totalMs / queries : 0.0) << " ms, worst " << worstMs << " ms\n";
+    oss << "Warm-up between ladders: mean " << (ladders ? warmMs / ladders : 0.0) << " ms, worst " << worstWarmMs << " ms";
+    drawAsciiBox(oss.str());
+}
+
+// Certifies a slots config: exact RTP over every stop combination, then a
+// multi-threaded Monte Carlo run that should land within a few standard errors.
+void certifySlots(const std::string& path, uint64_t spins, uint32_t seed) {
+    SlotConfig cfg = SlotConfig::classic();
+    std::string error;
+    if (!path.empty() && !loadSlotConfig(path, cfg, error)) {
+        drawAsciiBox(error);
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    const SlotRtpReport rep = computeSlotRtp(cfg);
+    const double exactMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    const SlotMonteCarlo mc = monteCarloSlots(cfg, spins, seed);
+    const double mcSecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const double stdErr = mc.spins ? rep.stdDev / std::sqrt(static_cast<double>(mc.spins)) : 0.0;
+    const double z = stdErr > 0.0 ? (mc.rtp() - rep.rtp) / stdErr : 0.0;
+
+    std::ostringstream oss;
+    oss << "SLOTS CERTIFICATION (" << (path.empty() ? "classic machine" : path) << ")\n\n";
+    oss << "Reel stops: " << cfg.strips[0].size() << " x " << cfg.strips[1].size() << " x " << cfg.strips[2].size()
+        << " = " << rep.combinations << " combinations\n";
+    oss << std::fixed << std::setprecision(4);
+    oss << "Exact RTP " << rep.rtp * 100.0 << "%  hit frequency " << rep.hitFrequency * 100.0 << "%\n";
+    oss << std::setprecision(3) << "Std dev per spin " << rep.stdDev << "  (" << exactMs << " ms)\n";
+    for (size_t i = 0; i < cfg.rules.size(); ++i) {
+        oss << "  " << cfg.describe(static_cast<int>(i));
+        if (cfg.isJackpot(static_cast<int>(i))) oss << "  POOL";
+        else oss << "  x" << std::setprecision(2) << cfg.rules[i].multiplier;
+        oss
+            << std::setprecision(1) << "  1 in " << (rep.ruleHits[i] ? static_cast<double>(rep.combinations) / rep.ruleHits[i] : 0.0)
+            << std::setprecision(3) << "  RTP " << rep.ruleContribution[i] * 100.0 << "%\n";
+    }
+    if (cfg.progressive()) {
+        oss << std::setprecision(3) << "Progressive: " << cfg.progressiveRate * 100.0 << "% of bets, seed "
+            << std::setprecision(2) << cfg.progressiveSeed << "\n" << std::setprecision(3) << "  adds " << rep.progressiveRtp(10.0, cfg.progressiveRate, cfg.progressiveSeed) * 100.0 << "% RTP at a 10 bet, "
+            << rep.progressiveRtp(100.0, cfg.progressiveRate, cfg.progressiveSeed) * 100.0 << "% at 100\n";
+    }
+    oss << "\nMonte Carlo: " << mc.spins << " spins on " << mc.threads << " threads\n";
+    oss << "RTP " << mc.rtp() * 100.0 << "%  (z = " << std::setprecision(2) << z << ")  "
+        << std::setprecision(1) << (mcSecs > 0.0 ? mc.spins / mcSecs / 1e6 : 0.0) << "M spins/s\n";
+    oss << (std::fabs(z) < 4.0 ? "Cross-check OK" : "Cross-check FAILED: Monte Carlo disagrees with the exact figure");
+    drawAsciiBox(oss.str());
+}
+
+// Certifies the 5x3 machine with every payline active: exact RTP over all stop
+// combinations, SIMD vs scalar agreement, per-spin evaluation cost and a Monte Carlo check.
+void certifyVideoSlots(const std::string& path, uint64_t spins, uint32_t seed) {
+    VideoSlotConfig cfg = VideoSlotConfig::standard();
+    std::string error;
+    if (!path.empty() && !loadVideoSlotConfig(path, cfg, error)) {
+        drawAsciiBox(error);
+        return;
+    }
+    const VideoSlotEvaluator eval(cfg, cfg.lineCount());
+
+    // Evaluation cost and SIMD/scalar agreement on random grids
+    const size_t samples = 1 << 20;
+    std::mt19937 gen(seed);
+    std::vector<uint8_t> grids(samples * 16);
+    for (size_t i = 0; i < samples; ++i) {
+        int stops[VideoSlotConfig::reels];
+        for (int k = 0; k < VideoSlotConfig::reels; ++k) stops[k] = static_cast<int>(gen() % cfg.strips[k].size());
+        cfg.fillGrid(stops, &grids[i * 16]);
+    }
+    uint64_t mismatches = 0, checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < samples; ++i) checksum += eval.evaluate(&grids[i * 16]).linePay;
+    const double evalNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / samples;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < samples; ++i) checksum -= eval.evaluateScalar(&grids[i * 16]).linePay;
+    const double scalarNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / samples;
+    for (size_t i = 0; i < samples; ++i) mismatches += !(eval.evaluate(&grids[i * 16]) == eval.evaluateScalar(&grids[i * 16]));
+
+    start = std::chrono::steady_clock::now();
+    const VideoSlotRtpReport rep = computeVideoSlotRtp(cfg, cfg.lineCount());
+    const double exactSecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const double returned = jobScheduler().parallelReduce(spins, 1u << 16, 0.0,
+        [&cfg, &eval, seed](const JobScheduler::Slice& s) {
+            std::mt19937 gen(s.seed(seed));
+            std::vector<double> batch;
+            double part = 0.0;
+            for (uint64_t done = 0; done < s.size(); ) {
+                const size_t n = static_cast<size_t>(std::min<uint64_t>(s.size() - done, 4096));
+                spinVideoSlotBatch(cfg, eval, gen, n, batch);
+                for (double m : batch) part += m;
+                done += n;
+            }
+            return part;
+        },
+        [](double& t, double p) { t += p; });
+
+    std::ostringstream oss;
+    oss << "VIDEO SLOTS CERTIFICATION (" << (path.empty() ? "built-in machine" : path) << ")\n\n";
+    oss << cfg.lineCount() << " lines, " << rep.combinations << " stop combinations\n";
+    oss << std::fixed << std::setprecision(4);
+    oss << "Exact RTP " << rep.rtp() * 100.0 << "%  hit frequency " << rep.hitFrequency() * 100.0 << "%\n";
+    oss << "Scatter pays 1 in " << std::setprecision(1) << (rep.scatterHits ? static_cast<double>(rep.combinations) / rep.scatterHits : 0.0)
+        << "  (" << std::setprecision(2) << exactSecs << " s)\n\n";
+#ifdef CASINO_SLOTS_SIMD
+    oss << "Evaluator: SIMD gather, ";
+#else
+    oss << "Evaluator: scalar, ";
+#endif
+    oss << std::setprecision(1) << evalNs << " ns/spin (scalar " << scalarNs << " ns)\n";
+#ifndef CASINO_SLOTS_SIMD
+    oss << "(build with SSSE3/AVX for the SIMD gather)\n";
+#endif
+    oss << "SIMD vs scalar mismatches: " << mismatches << (checksum ? " (checksum differs)" : "") << "\n\n";
+    oss << std::setprecision(4) << "Monte Carlo: " << spins << " spins on " << jobScheduler().threads() << " threads, RTP " << (spins ? returned / spins * 100.0 : 0.0) << "%";
+    drawAsciiBox(oss.str());
+}
+
+// Spins against one shared progressive pool from 1..N threads to show that
+// contributions scale; a single mutex-guarded total is timed alongside for contrast.
+// Each run gets a scheduler of its own size.
+void benchmarkJackpot(uint64_t spins, uint32_t seed) {
+    SlotConfig cfg = SlotConfig::classic();
+    cfg.progressiveRate = 0.01;
+    cfg.progressiveSeed = 500.0;
+    const unsigned maxThreads = std::max(4u, std::thread::hardware_concurrency());
+
+    struct MutexPool {
+        std::mutex m;
+        double total = 500.0;
+        void contribute(double a) { std::lock_guard<std::mutex> lock(m); total += a; }
+        double claim() { std::lock_guard<std::mutex> lock(m); double won = total; total = 500.0; return won; }
+    };
+
+    auto run = [&](JobScheduler& jobs, auto& pool, uint64_t& jackpots) {
+        auto start = std::chrono::steady_clock::now();
+        jackpots = jobs.parallelReduce(spins, 1u << 16, uint64_t(0),
+            [&](const JobScheduler::Slice& s) {
+                std::mt19937 gen(s.seed(seed));
+                std::vector<int16_t> batch;
+                uint64_t hits = 0;
+                for (uint64_t done = 0; done < s.size(); done += batch.size()) {
+                    spinSlotBatch(cfg, gen, static_cast<size_t>(std::min<uint64_t>(s.size() - done, 4096)), batch);
+                    for (int16_t rule : batch) {
+                        pool.contribute(10.0 * cfg.progressiveRate);
+                        if (cfg.isJackpot(rule)) { pool.claim(); ++hits; }
+                    }
+                }
+                return hits;
+            },
+            [](uint64_t& t, uint64_t p) { t += p; });
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    std::ostringstream oss;
+    oss << "PROGRESSIVE JACKPOT SCALING (" << spins << " spins per run, " << std::thread::hardware_concurrency() << " cores)\n\n";
+    oss << std::fixed << std::setprecision(1);
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        JobScheduler jobs(threads);
+        ProgressiveJackpot sharded(500.0);
+        MutexPool locked;
+        uint64_t hitsSharded = 0, hitsLocked = 0;
+        const double a = run(jobs, sharded, hitsSharded);
+        const double b = run(jobs, locked, hitsLocked);
+        oss << threads << " thread(s): sharded " << spins / a / 1e6 << "M spins/s, mutex " << spins / b / 1e6
+            << "M spins/s  (" << hitsSharded << " hits)\n";
+    }
+    drawAsciiBox(oss.str());
+}
+
+//------Poker-------//
+// The table's opponents playing each other. Every seat follows the rule the
+// AI in BasicPoker aims for, judged on the cards actually dealt: a pair or
+// better to stay in on each street, otherwise a 20% bluff (30% in seats before
+// the button). Survivors go to a showdown on the table's own evaluator.
+// Around four hands in ten fold out preflop without scoring a single 5-card
+// hand, while a showdown scores every live seat on every street, so jobs vary
+// widely in cost and the scheduler has to steal to keep every core busy.
+struct PokerSimResult {
+    static constexpr int streets = 5; // Pre-Flop, Flop, Turn, River, Showdown
+    uint64_t hands = 0;
+    uint64_t endedOn[streets] = {};
+    uint64_t winningRank[10] = {};
+    uint64_t splitPots = 0;
+    uint64_t evaluations = 0; // 5-card hands scored
+
+    PokerSimResult& operator+=(const PokerSimResult& o) {
+        hands += o.hands;
+        for (int i = 0; i < streets; ++i) endedOn[i] += o.endedOn[i];
+        for (int i = 0; i < 10; ++i) winningRank[i] += o.winningRank[i];
+        splitPots += o.splitPots;
+        evaluations += o.evaluations;
+        return *this;
+    }
+    bool operator==(const PokerSimResult& o) const {
+        return hands == o.hands && splitPots == o.splitPots && evaluations == o.evaluations
+            && std::equal(endedOn, endedOn + streets, o.endedOn) && std::equal(winningRank, winningRank + 10, o.winningRank);
+    }
+};
+
+using PokerTable = BasicPoker<NullView>;
+
+// Best hand from the hole cards and the community cards dealt so far
+PokerTable::HandRank bestDealtPokerHand(const PokerTable& table, const std::vector<Card>& hole, const std::vector<Card>& community, uint64_t& evaluations) {
+    if (community.empty()) {
+        const int hi = std::max<int>(hole[0].getRank(), hole[1].getRank());
+        const int lo = std::min<int>(hole[0].getRank(), hole[1].getRank());
+        return hi == lo ? PokerTable::HandRank{ 1, { hi } } : PokerTable::HandRank{ 0, { hi, lo } };
+    }
+    if (community.size() == 5) {
+        evaluations += 21;
+        return table.bestHandFromSeven(hole, community);
+    }
+    // Flop: the one hand; turn: leave out each of the six cards in turn
+    const Card all[6] = { hole[0], hole[1], community[0], community[1], community[2], community.size() > 3 ? community[3] : community[0] };
+    const int n = 2 + static_cast<int>(community.size());
+    PokerTable::HandRank best{ -1, {} };
+    for (int skip = (n == 6 ? 0 : 5); skip < 6; ++skip) {
+        int pick[5], k = 0;
+        for (int i = 0; i < 6 && k < 5; ++i) if (i != skip) pick[k++] = i;
+        const std::array<Card, 5> hand{ { all[pick[0]], all[pick[1]], all[pick[2]], all[pick[3]], all[pick[4]] } };
+        const PokerTable::HandRank hr = table.evaluate5(hand);
+        ++evaluations;
+        if (best < hr) best = hr;
+    }
+    return best;
+}
+
+PokerSimResult simulatePokerTable(uint64_t hands, uint32_t seed, int seats, JobScheduler& jobs) {
+    const PokerTable table(seats);
+    return jobs.parallelReduce(hands, 256, PokerSimResult(),
+        [&table, seed, seats](const JobScheduler::Slice& s) {
+            std::mt19937 gen(s.seed(seed));
+            std::uniform_int_distribution<int> percent(1, 100);
+            std::vector<Card> deck;
+            for (int suit = Card::Hearts; suit <= Card::Spades; ++suit)
+                for (int rank = Card::Two; rank <= Card::Ace; ++rank) deck.emplace_back(static_cast<Card::Rank>(rank), static_cast<Card::Suit>(suit));
+            std::vector<std::vector<Card>> hole(static_cast<size_t>(seats));
+            std::vector<PokerTable::HandRank> held(static_cast<size_t>(seats));
+            std::vector<bool> in(static_cast<size_t>(seats));
+            std::vector<Card> community;
+            PokerSimResult res;
+
+            for (uint64_t h = s.begin; h < s.end; ++h) {
+                std::shuffle(deck.begin(), deck.end(), gen);
+                const int button = static_cast<int>(h % seats);
+                for (int p = 0; p < seats; ++p) {
+                    hole[p].assign(deck.begin() + 2 * p, deck.begin() + 2 * p + 2);
+                    in[p] = true;
+                }
+                community.clear();
+                ++res.hands;
+
+                int live = seats, street = 0;
+                for (; street < 4 && live > 1; ++street) {
+                    if (street == 1) community.assign(deck.begin() + 2 * seats, deck.begin() + 2 * seats + 3);
+                    else if (street > 1) community.push_back(deck[2 * seats + street + 1]);
+                    for (int p = 0; p < seats; ++p) {
+                        if (!in[p]) continue;
+                        held[p] = bestDealtPokerHand(table, hole[p], community, res.evaluations);
+                        if (held[p].rank >= 1 || percent(gen) <= 20 + (p < button ? 10 : 0)) continue;
+                        in[p] = false;
+                        --live;
+                    }
+                }
+                if (live <= 1) {
+                    res.endedOn[street - 1]++;
+                    continue;
+                }
+
+                res.endedOn[PokerSimResult::streets - 1]++;
+                int winners = 0;
+                PokerTable::HandRank best{ -1, {} };
+                for (int p = 0; p < seats; ++p) {
+                    if (!in[p]) continue;
+                    if (best < held[p]) { best = held[p]; winners = 1; }
+                    else if (best == held[p]) ++winners;
+                }
+                res.winningRank[best.rank]++;
+                res.splitPots += winners > 1;
+            }
+            return res;
+        },
+        [](PokerSimResult& total, const PokerSimResult& part) { total += part; });
+}
+
+void simulatePoker(uint64_t hands, uint32_t seed) {
+    const int seats = 6;
+    JobScheduler& jobs = jobScheduler();
+    const uint64_t stealsBefore = jobs.steals();
+    auto start = std::chrono::steady_clock::now();
+    const PokerSimResult r = simulatePokerTable(hands, seed, seats, jobs);
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    static const char* streetNames[PokerSimResult::streets] = { "Pre-Flop", "Flop", "Turn", "River", "Showdown" };
+    const PokerTable table;
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2);
+    oss << "POKER TABLE (" << r.hands << " hands, " << seats << " seats, " << jobs.threads() << " threads)\n\nHands ended on\n";
+    for (int i = 0; i < PokerSimResult::streets; ++i)
+        oss << "  " << std::left << std::setw(10) << streetNames[i] << std::right << std::setw(7) << (r.hands ? 100.0 * r.endedOn[i] / r.hands : 0.0) << "%\n";
+    const uint64_t showdowns = r.endedOn[PokerSimResult::streets - 1];
+    oss << "Showdowns won with\n";
+    for (int rank = 9; rank >= 0; --rank) {
+        if (!r.winningRank[rank]) continue;
+        oss << "  " << std::left << std::setw(16) << table.handRankName(rank) << std::right << std::setw(7) << 100.0 * r.winningRank[rank] / showdowns << "%\n";
+    }
+    oss << "Split pots: " << r.splitPots << "\n";
+    oss << std::setprecision(1) << "Evaluator: " << (r.hands ? static_cast<double>(r.evaluations) / r.hands : 0.0) << " hands scored per deal\n";
+    oss << (secs > 0.0 ? r.hands / secs / 1e3 : 0.0) << "k deals/s, " << JobScheduler::chunks(hands, 256) << " jobs, "
+        << jobs.steals() - stealsBefore << " ranges stolen";
+    drawAsciiBox(oss.str());
+}
+
+//------Scheduler scaling-------//
+// Runs the uneven Poker table and the even Blackjack shoe on pools of 1..N
+// threads. Each pool must reproduce the single-thread figures exactly.
+void benchmarkScheduler(uint64_t hands, uint32_t seed) {
+    const unsigned maxThreads = std::max(4u, std::thread::hardware_concurrency());
+    const uint64_t rounds = hands * 40;
+    std::ostringstream oss;
+    oss << "JOB SCHEDULER SCALING (" << std::thread::hardware_concurrency() << " cores)\n";
+    oss << hands << " poker deals, " << rounds << " blackjack rounds per run\n\n";
+    oss << std::fixed << std::setprecision(2);
+
+    PokerSimResult pokerRef;
+    BlackjackSimResult blackjackRef;
+    double pokerBase = 0.0, blackjackBase = 0.0;
+    for (unsigned threads = 1;; threads = std::min(threads * 2, maxThreads)) {
+        JobScheduler jobs(threads);
+        auto start = std::chrono::steady_clock::now();
+        const PokerSimResult poker = simulatePokerTable(hands, seed, 6, jobs);
+        const double pokerSecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const uint64_t steals = jobs.steals();
+        start = std::chrono::steady_clock::now();
+        const BlackjackSimResult blackjack = simulateBlackjack<ClassicRules>(rounds, seed, jobs);
+        const double blackjackSecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (threads == 1) {
+            pokerRef = poker;
+            blackjackRef = blackjack;
+            pokerBase = pokerSecs;
+            blackjackBase = blackjackSecs;
+        }
+        const bool same = poker == pokerRef && blackjack.rounds == blackjackRef.rounds && blackjack.returned == blackjackRef.returned
+            && blackjack.handsWon == blackjackRef.handsWon;
+        oss << std::setw(2) << threads << " thread(s): poker x" << (pokerSecs > 0.0 ? pokerBase / pokerSecs : 0.0)
+            << " (" << steals << " steals), blackjack x" << (blackjackSecs > 0.0 ? blackjackBase / blackjackSecs : 0.0)
+            << (same ? "" : "  FIGURES DIFFER") << "\n";
+        if (threads == maxThreads) break;
+    }
+    oss << "\nSpeed-up is against one thread; every run deals the same cards.";
+    drawAsciiBox(oss.str());
+}
+
+//------Saved profiles-------//
+// Fills bench_saves/ with `count` random profiles, then times what startup
+// does (finding and loading one profile by name) against reading them all,
+// checks every round trip and that a flipped byte is caught. Removes the
+// directory afterwards.
+void benchmarkProfiles(uint64_t count, uint32_t seed) {
+    using clock = std::chrono::steady_clock;
+    const ProfileStore store("bench_saves");
+    std::error_code ec;
+    std::filesystem::remove_all(store.directory(), ec);
+    std::mt19937 gen(seed);
+    std::vector<ProfileSnapshot> profiles(static_cast<size_t>(count));
+    for (size_t i = 0; i < profiles.size(); ++i) {
+        ProfileSnapshot& p = profiles[i];
+        p.name = "Player " + std::to_string(i);
+        p.balance = static_cast<int64_t>(gen() % 100000000000ULL);
+        p.mana = static_cast<int32_t>(gen() % 101);
+        p.blessings = static_cast<uint8_t>(gen() & 7);
+        if (gen() & 1) p.curses.push_back({ "Muddled Sight", 2 });
+        if (gen() & 1) p.curses.push_back({ "Unlucky Hand", 3 });
+        p.earnings = gen();
+        p.losses = gen();
+        p.savedAt = 1700000000 + gen() % 100000000;
+    }
+
+    auto start = clock::now();
+    std::string error;
+    for (const ProfileSnapshot& p : profiles) {
+        if (!store.save(p, error)) break;
+    }
+    const double saveSecs = std::chrono::duration<double>(clock::now() - start).count();
+    if (!error.empty()) {
+        drawAsciiBox(error);
+        return;
+    }
+
+    // What a launch does: one profile by name
+    const size_t probes = std::min<size_t>(profiles.size(), 1000);
+    ProfileSnapshot loaded;
+    start = clock::now();
+    for (size_t i = 0; i < probes; ++i) (void)store.load(profiles[(i * 7919) % profiles.size()].name, loaded, error);
+    const double oneSecs = std::chrono::duration<double>(clock::now() - start).count() / std::max<size_t>(probes, 1);
+
+    size_t mismatches = 0;
+    start = clock::now();
+    for (const ProfileSnapshot& p : profiles) {
+        const bool same = store.load(p.name, loaded, error) && loaded.name == p.name && loaded.balance == p.balance && loaded.mana == p.mana
+            && loaded.blessings == p.blessings && loaded.curses.size() == p.curses.size() && loaded.earnings == p.earnings
+            && loaded.losses == p.losses && loaded.savedAt == p.savedAt;
+        if (!same) ++mismatches;
+    }
+    const double allSecs = std::chrono::duration<double>(clock::now() - start).count();
+
+    // Flip one payload byte of the first profile; the load must refuse it
+    bool caught = false;
+    if (!profiles.empty()) {
+        const std::string path = store.pathFor(profiles[0].name);
+        if (std::FILE* f = std::fopen(path.c_str(), "r+b")) {
+            std::fseek(f, static_cast<long>(profileHeaderSize) + 3, SEEK_SET);
+            const int c = std::fgetc(f);
+            std::fseek(f, static_cast<long>(profileHeaderSize) + 3, SEEK_SET);
+            std::fputc(c ^ 0x10, f);
+            std::fclose(f);
+        }
+        caught = !store.load(profiles[0].name, loaded, error) && !error.empty();
+    }
+    std::filesystem::remove_all(store.directory(), ec);
+
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2);
+    oss << "SAVED PROFILES (" << count << " in " << store.directory() << "/)\n\n";
+    oss << "Save (write, flush to disk, rename): " << saveSecs / std::max<uint64_t>(count, 1) * 1e3 << " ms each\n";
+    oss << "Startup, one profile by name: " << oneSecs * 1e6 << " us\n";
+    oss << "Reading every profile: " << allSecs * 1e3 << " ms\n";
+    oss << "Round trips: " << (mismatches == 0 ? "all match" : std::to_string(mismatches) + " MISMATCHED") << "\n";
+    oss << "Flipped byte: " << (caught ? "caught by the checksum" : "NOT DETECTED");
+    drawAsciiBox(oss.str());
+}
+
+//------Soak test: the real games, driven by a bot-------//
+// Every table is played round-robin through its actual game code, built with
+// NullView and answered by a bot through the same InputSource the keyboard
+// uses. The bot picks a random legal key from its own seeded generator and
+// always stakes the minimum, so it never runs the bankroll dry.
+struct SoakBot {
+    std::mt19937 gen;
+    uint64_t decisions = 0;
+
+    explicit SoakBot(uint32_t seed = 5489u) : gen(seed) {}
+
+    Action key(const Prompt& prompt) {
+        ++decisions;
+        Action bound[32];
+        int n = 0;
+        for (int a = 1; a < 32; ++a)
+            if (prompt.keys->has(static_cast<Action>(a))) bound[n++] = static_cast<Action>(a);
+        return n ? bound[gen() % static_cast<unsigned>(n)] : Action::None;
+    }
+    double number(const Prompt& prompt) {
+        ++decisions;
+        return prompt.minv;
+    }
+    std::string text(const Prompt&) { return "Soak Bot"; }
+};
+
+struct SoakPass {
+    std::vector<double> secs; // per table, in registry order
+    uint64_t decisions = 0;
+    double earnings = 0.0, losses = 0.0;
+};
+
+// Plays `rounds` of every table from fresh tables, a fresh player and the given
+// seed for both the deal and the bot, so two passes with one seed do the same work
+SoakPass soakPass(uint64_t rounds, uint32_t seed, EventLog* log) {
+    rng().seed(seed);
+    BotInput<SoakBot> bot{ SoakBot(seed) };
+    Player player("Soak Bot", 1e12);
+    CasinoManager casino(player, bot);
+    GameRoom room(true);
+    EventLog off;
+    EventScope recording(log ? *log : off);
+
+    SoakPass pass;
+    for (size_t t = 0; t < room.size(); ++t) {
+        AnyGame& game = room.table(t);
+        const uint8_t id = static_cast<uint8_t>(room.info(t).order);
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t r = 0; r < rounds; ++r) {
+            beginEventRound(id);
+            runTask(game.play(player, casino)); // never suspends: bot answers, NullView tables
+            endEventRound();
+        }
+        pass.secs.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    pass.decisions = bot.policy().decisions;
+    pass.earnings = casino.totalEarnings;
+    pass.losses = casino.totalLosses;
+    return pass;
+}
+
+// After a warm-up, plays the same seeded session without and then with the
+// round log (soak_events.log). The two timings are as noisy as the machine, so
+// the cost is also worked out from the time to append one record and to check
+// for a due flush between rounds, measured on a scratch log that is deleted
+// afterwards so soak_events.log holds only the rounds played.
+void soakSession(uint64_t rounds, uint32_t seed) {
+    const GameRegistry& registry = GameRegistry::instance();
+    if (registry.size() == 0) return;
+    const uint64_t perTable = std::max<uint64_t>(rounds / registry.size(), 1);
+
+    (void)soakPass(std::max<uint64_t>(perTable / 20, 1), seed, nullptr);
+    const SoakPass bare = soakPass(perTable, seed, nullptr);
+    static EventLog events;
+    std::string error;
+    if (!events.open("soak_events.log", error, true)) drawAsciiBox(error);
+    const SoakPass logged = soakPass(perTable, seed, &events);
+    const uint64_t records = events.recordsWritten();
+    events.close();
+
+    static EventLog scratch;
+    const char* scratchPath = "soak_events.scratch";
+    if (!scratch.open(scratchPath, error, true)) drawAsciiBox(error);
+
+    // Append cost: a burst of records through the buffer, batch writes included
+    const uint64_t burst = 1u << 20;
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < burst; ++i) scratch.append(EventType::CardDealt, static_cast<uint8_t>(i % 52), 0, 0);
+    scratch.flush();
+    const double perRecord = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / burst;
+
+    // Between-round cost: the due check, and a write when the interval has passed
+    const uint64_t checks = 1u << 16;
+    start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < checks; ++i) scratch.flushIfDue();
+    const double perRound = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / checks;
+    scratch.close();
+    std::remove(scratchPath);
+    const double logSecs = records * perRecord + perTable * registry.size() * perRound;
+
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2);
+    oss << "SOAK SESSION (" << perTable << " rounds per table, seed " << seed << ")\n\n";
+    double total = 0.0, totalBare = 0.0;
+    for (size_t t = 0; t < registry.size(); ++t) {
+        total += logged.secs[t];
+        totalBare += bare.secs[t];
+        oss << std::left << std::setw(12) << registry.games()[t].info.name << std::right << std::setw(10) << logged.secs[t] * 1e3 << " ms  "
+            << std::setw(12) << (logged.secs[t] > 0.0 ? perTable / logged.secs[t] : 0.0) << " rounds/s\n";
+    }
+    oss << "\n" << perTable * registry.size() << " rounds, " << logged.decisions << " decisions in " << total << " s\n";
+    oss << "Earnings " << logged.earnings << "  Losses " << logged.losses << "\n";
+    oss << "Round log: " << records << " records at " << perRecord * 1e9 << " ns, a flush check per round at "
+        << perRound * 1e9 << " ns\n = " << (total > 0.0 ? logSecs / total * 100.0 : 0.0) << "% of play time at bot speed\n";
+    oss << "(timed: " << std::showpos << (totalBare > 0.0 ? (total / totalBare - 1.0) * 100.0 : 0.0) << std::noshowpos
+        << "% against the same session unlogged)";
+    if (bare.decisions != logged.decisions) oss << "\n(passes diverged: " << bare.decisions << " vs " << logged.decisions << " decisions)";
+    drawAsciiBox(oss.str());
+}
+
+//------Round log audit-------//
+// Maps an event log and totals it per game in one pass over the records
+void auditEventLog(const std::string& path) {
+    MappedEventLog log;
+    std::string error;
+    if (!log.open(path, error)) {
+        drawAsciiBox(error);
+        return;
+    }
+
+    struct GameTotals { uint64_t rounds = 0; int64_t staked = 0, returned = 0, lost = 0; };
+    GameTotals games[256];
+    uint64_t byType[eventTypeCount] = {};
+    uint64_t sessions = 0, cards[52] = {};
+
+    auto start = std::chrono::steady_clock::now();
+    for (const EventRecord& r : log) {
+        const auto type = static_cast<unsigned>(r.type);
+        if (type < eventTypeCount) ++byType[type];
+        GameTotals& g = games[r.game];
+        switch (r.type) {
+        case EventType::SessionStart: ++sessions; break;
+        case EventType::RoundStart: ++g.rounds; break;
+        case EventType::BetPlaced: g.staked += r.amount; break;
+        case EventType::Payout:
+        case EventType::Refund: g.returned += r.amount; break;
+        case EventType::Loss: g.lost += r.amount; break;
+        case EventType::CardDealt: if (r.detail < 52) ++cards[r.detail]; break;
+        default: break;
+        }
+    }
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint64_t rounds = 0;
+    for (const GameTotals& g : games) rounds += g.rounds;
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2);
+    oss << "ROUND LOG AUDIT: " << path << "\n";
+    oss << log.size() << " records, " << sessions << " sessions, " << rounds << " rounds\n\n";
+    const GameRegistry& registry = GameRegistry::instance();
+    for (int id = 0; id < 256; ++id) {
+        const GameTotals& g = games[id];
+        if (!g.rounds && !g.staked) continue;
+        std::string name = "game " + std::to_string(id);
+        for (const GameRegistry::Entry& e : registry.games()) if (e.info.order == id) name = std::string(e.info.name);
+        oss << std::left << std::setw(12) << name << std::right << std::setw(9) << g.rounds << " rounds  staked "
+            << g.staked / 1e6 << "  returned " << g.returned / 1e6 << "  RTP "
+            << (g.staked ? 100.0 * g.returned / g.staked : 0.0) << "%\n";
+    }
+    uint64_t dealt = 0, fewest = ~0ull, most = 0;
+    for (uint64_t c : cards) { dealt += c; fewest = std::min(fewest, c); most = std::max(most, c); }
+    oss << "\n" << dealt << " cards dealt (per card " << fewest << ".." << most << "), "
+        << byType[static_cast<int>(EventType::BlessingCast)] << " blessings, "
+        << byType[static_cast<int>(EventType::CurseApplied)] << " curses\n";
+    oss << std::setprecision(1) << "Scanned in " << secs * 1e3 << " ms: "
+        << (secs > 0.0 ? log.size() / secs / 1e6 : 0.0) << "M records/s, "
+        << (secs > 0.0 ? rounds / secs / 1e6 : 0.0) << "M rounds/s";
+    drawAsciiBox(oss.str());
+}
+
+// Returns true if argv asked for a simulation (and it ran), false to start the casino normally
+bool runSimulatorFromArgs(int argc, char* argv[]) {
+    if (argc < 3 || std::strcmp(argv[1], "--simulate") != 0) return false;
+
+    // --jobs <n> after the game name sizes the job scheduler, --metrics dumps
+    // the phase timings and counters once the run is over, and --trace <file>
+    // writes a Chrome trace of the run (Trace.h); the rest stay positional
+    std::vector<char*> args(argv, argv + argc);
+    bool dumpMetrics = false;
+    for (size_t i = 3; i < args.size();) {
+        if (std::strcmp(args[i], "--metrics") == 0) {
+            dumpMetrics = true;
+            args.erase(args.begin() + static_cast<std::ptrdiff_t>(i));
+        }
+        else if (std::strcmp(args[i], "--jobs") == 0 && i + 1 < args.size()) {
+            jobScheduler(static_cast<unsigned>(std::strtoul(args[i + 1], nullptr, 10)));
+            args.erase(args.begin() + static_cast<std::ptrdiff_t>(i), args.begin() + static_cast<std::ptrdiff_t>(i) + 2);
+        }
+        else if (std::strcmp(args[i], "--trace") == 0 && i + 1 < args.size()) {
+            std::string error;
+            if (!traceLog().open(args[i + 1], error)) drawAsciiBox(error + "\nRunning without a trace.");
+            args.erase(args.begin() + static_cast<std::ptrdiff_t>(i), args.begin() + static_cast<std::ptrdiff_t>(i) + 2);
+        }
+        else ++i;
+    }
+    argc = static_cast<int>(args.size());
+    argv = args.data();
+
+    const std::string game = argv[2];
+    const uint64_t rounds = (argc > 3) ? std::strtoull(argv[3], nullptr, 10) : 1000000ULL;
+    const uint32_t seed = (argc > 4) ? static_cast<uint32_t>(std::strtoul(argv[4], nullptr, 10)) : 5489u;
+
+    TraceSpan span("simulate", game);
+    if (game == "blackjack") simulateBlackjackVariants(rounds, seed);
+    else if (game == "baccarat") auditBaccaratShoes((argc > 3) ? rounds : 20, seed);
+    else if (game == "highlow") simulateHighLow(rounds, seed);
+    else if (game == "poker") simulatePoker((argc > 3) ? rounds : 200000ULL, seed);
+    else if (game == "scheduler") benchmarkScheduler((argc > 3) ? rounds : 20000ULL, seed);
+    else if (game == "slots") certifySlots((argc > 5) ? argv[5] : "", (argc > 3) ? rounds : 20000000ULL, seed);
+    else if (game == "video-slots") certifyVideoSlots((argc > 5) ? argv[5] : "", (argc > 3) ? rounds : 5000000ULL, seed);
+    else if (game == "jackpot") benchmarkJackpot((argc > 3) ? rounds : 20000000ULL, seed);
+    else if (game == "highlow-ladder") simulateHighLowLadder((argc > 3) ? rounds : 5000ULL, seed);
+    else if (game == "baccarat-roads") simulateBaccaratRoads(rounds, seed);
+    else if (game == "baccarat-kernel") simulateBaccaratKernel((argc > 3) ? rounds : 50000000ULL, seed);
+    else if (game == "session") soakSession((argc > 3) ? rounds : 60000ULL, seed);
+    else if (game == "audit") auditEventLog((argc > 3) ? argv[3] : "events.log");
+    else if (game == "profiles") benchmarkProfiles((argc > 3) ? rounds : 5000ULL, seed);
+    else drawAsciiBox("Unknown simulation: " + game + "\nAvailable: blackjack, baccarat, baccarat-kernel, baccarat-roads, highlow, highlow-ladder, poker, slots, video-slots, jackpot, scheduler, session, audit, profiles");
+    if (dumpMetrics) drawAsciiBox(readMetrics().describe());
+    return true;
+}
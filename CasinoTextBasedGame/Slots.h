@@ -1,83 +1,135 @@
 ﻿#pragma once
 #include "Main.h"
+#include "SlotsEngine.h"
+#include "GameRegistry.h"
+#include "View.h"
 #include <chrono>
-#include <thread>
 
-class Slots {
+// View is ConsoleView or NullView (View.h); see the Slots alias below
+template <typename View = ConsoleView>
+class BasicSlots {
 private:
-    std::vector<std::string> symbols;
+    View view;
+    SlotConfig config;
+    std::string configNote; // shown on the first spin if slots.cfg exists but is broken
+    std::minstd_rand flicker{ 12345 }; // decoy symbols while the reels spin
 
-    void showReels(const std::vector<std::string>& reels) {
-        std::cout << "\r[ " << reels[0] << " | " << reels[1] << " | " << reels[2] << " ] " << std::flush;
+    // 20 flickering frames that slow down, then the reels stop one by one.
+    // Decoy symbols come from their own generator, so the game's draws are
+    // the same whether or not there is a view to animate
+    Task<void> spinAnimation(const int finalReels[SlotConfig::reelCount]) {
+        const int totalCycles = 20;     // total spin cycles
+        const int initialDelay = 60;    // initial delay (ms), +15 ms per cycle
+        co_await view.animate(totalCycles + SlotConfig::reelCount, [&](FrameBuffer& out, int i) {
+            int reels[SlotConfig::reelCount];
+            const int stopped = i < totalCycles ? 0 : i - totalCycles + 1;
+            for (int k = 0; k < SlotConfig::reelCount; ++k)
+                reels[k] = k < stopped ? finalReels[k] : config.strips[k][flicker() % config.strips[k].size()];
+            out << "[ " << config.glyphs[reels[0]] << " | " << config.glyphs[reels[1]] << " | " << config.glyphs[reels[2]] << " ]";
+            return i < totalCycles ? initialDelay + 15 * i : 350;
+        });
     }
 
-    void spinAnimation(std::vector<std::string>& finalReels) {
-        std::vector<std::string> reels = { " ", " ", " " };
-
-        int totalCycles = 20;     // total spin cycles
-        int delay = 60;           // initial delay (ms)
-        for (int cycle = 0; cycle < totalCycles; ++cycle) {
-            // Randomize symbols each frame
-            for (int i = 0; i < 3; ++i)
-                reels[i] = symbols[randint(0, (int)symbols.size() - 1)];
-
-            showReels(reels);
-            std::this_thread::sleep_for(std::chrono::milliseconds(delay));
-
-            // Gradually slow down
-            delay += 15;
+    // N spins at a fixed bet, no animation: outcomes are drawn in one batch,
+    // settled quietly in order and reported in a single summary box
+    Task<void> autoSpin(Player& player, CasinoManager& casino) {
+        const double bet = co_await casino.input.readDouble(u8"Bet per spin (£10–£1000): ", 10, 1000);
+        AutoSpinPlan plan = co_await readAutoSpinPlan(casino.input, bet);
+        if (config.progressive()) {
+            plan.jackpot = &progressiveJackpot(config.progressiveSeed);
+            plan.jackpotRate = config.progressiveRate;
         }
 
-        // Reveal each reel one by one
-        for (int i = 0; i < 3; ++i) {
-            reels[i] = finalReels[i];
-            showReels(reels);
-            std::this_thread::sleep_for(std::chrono::milliseconds(350));
+        auto start = std::chrono::steady_clock::now();
+        std::vector<int16_t> outcomes;
+        spinSlotBatch(config, rng(), static_cast<size_t>(plan.spins), outcomes);
+        countMetric(Counter::EvaluatorCalls, outcomes.size());
+        std::vector<double> multipliers(outcomes.size());
+        for (size_t i = 0; i < outcomes.size(); ++i) {
+            const int rule = outcomes[i];
+            multipliers[i] = rule < 0 ? 0.0 : config.isJackpot(rule) ? autoSpinJackpot : config.rules[rule].multiplier;
         }
-        std::cout << std::endl;
+
+        settleAutoSpins(view, player, casino, plan, multipliers, start);
     }
 
 public:
-    Slots() {
-        symbols = { u8"🍒", u8"🍋", u8"🔔", u8"💎", u8"7️⃣", u8"⭐" };
+    // Reel strips and paytable come from slots.cfg in the working directory;
+    // without one the machine is the classic six-symbol game
+    BasicSlots() : config(SlotConfig::classic()) {
+        const std::string path = "slots.cfg";
+        std::string error;
+        if (std::ifstream(path) && !loadSlotConfig(path, config, error)) {
+            configNote = error + "\nUsing the classic machine instead.";
+        }
     }
 
-    void play(Player& player, CasinoManager& casino) {
+    const SlotConfig& machine() const { return config; }
+
+    Task<void> play(Player& player, CasinoManager& casino) {
+        TraceSpan span("Slots::play");
+        if (!configNote.empty()) {
+            view.box(configNote);
+            configNote.clear();
+        }
+
+        const int mode = co_await casino.input.readChoice("1) Single spin  2) Auto-spin: ", 1, 2);
+        if (mode == 2) {
+            co_await autoSpin(player, casino);
+            co_return;
+        }
+
+        if (config.progressive()) {
+            view.box(u8"Progressive jackpot: £", Fixed{ progressiveJackpot(config.progressiveSeed).value() });
+        }
+
         double bet;
-        if (!casino.placeBet(bet)) { return; }
+        const bool placed = co_await casino.placeBet(bet, 10, 1000, View::enabled);
+        if (!placed) { co_return; }
+        if (config.progressive()) progressiveJackpot(config.progressiveSeed).contribute(bet * config.progressiveRate);
 
-        drawAsciiBox("Press Enter to SPIN the reels!");
-        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-        std::cin.get();
+        view.box("Press any key to SPIN the reels!");
+        co_await casino.input.pauseEnter("");
 
-        // Generate final result
-        int a = randint(0, (int)symbols.size() - 1);
-        int b = randint(0, (int)symbols.size() - 1);
-        int c = randint(0, (int)symbols.size() - 1);
-        std::vector<std::string> finalReels = { symbols[a], symbols[b], symbols[c] };
+        // Generate final result: one stop per reel strip
+        int sym[SlotConfig::reelCount];
+        for (int i = 0; i < SlotConfig::reelCount; ++i) {
+            sym[i] = config.strips[i][randint(0, (int)config.strips[i].size() - 1)];
+        }
 
         // Animation before result
-        spinAnimation(finalReels);
+        co_await spinAnimation(sym);
 
-        // Outcome logic
-        if (a == b && b == c) {
-            drawAsciiBox("JACKPOT! You win 10x your bet!");
-            casino.processWin(bet, 11.0);
+        // Outcome logic: the first matching pay line wins
+        int rule;
+        {
+            PhaseTimer timing(Phase::Evaluate);
+            countMetric(Counter::EvaluatorCalls);
+            rule = config.evaluate(sym[0], sym[1], sym[2]);
+        }
+        if (config.isJackpot(rule)) {
+            const double prize = progressiveJackpot(config.progressiveSeed).claim();
+            view.box("PROGRESSIVE JACKPOT! ", config.describe(rule), u8"! You win £", Fixed{ prize }, "!");
+            casino.processWin(bet, 1.0 + prize / bet, View::enabled);
         }
-        else if (a == b || b == c || a == c) {
-            drawAsciiBox("Two match! You win 2x!");
-            casino.processWin(bet, 2.0);
+        else if (rule >= 0) {
+            const double mult = config.rules[rule].multiplier;
+            view.box(mult >= 10.0 ? "JACKPOT! " : "", config.describe(rule), "! Pays ", mult, "x your bet.");
+            casino.processWin(bet, mult, View::enabled);
         }
         else {
-            drawAsciiBox("No win. Better luck next time.");
-            maybeApplyRandomCurseAfterLoss(player);
-            casino.processLoss(bet);
+            view.box("No win. Better luck next time.");
+            maybeApplyRandomCurseAfterLoss(player, View::enabled);
+            casino.processLoss(bet, View::enabled);
         }
 
         player.regenerateMana();
-        player.decayCurses();
+        player.decayCurses(View::enabled);
         player.clearBlessings();
 
-        showRoundSummary(player);
+        view.status(player);
     }
 };
+
+using Slots = BasicSlots<ConsoleView>;
+inline const bool slotsRegistered = registerGame<Slots, BasicSlots<NullView>>({ "Slots", "Slots", 5, AutoPlay });
@@ -0,0 +1,420 @@
+﻿#pragma once
+#include "Main.h"
+#include "JobScheduler.h"
+#include "ProgressiveJackpot.h"
+#include "View.h"
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+
+//================== Slot Machine Config ==================//
+//------Reel strips and paytable, loaded from a plain-text file-------//
+// Format (one directive per line, # starts a comment):
+//   symbol <name> <glyph>          declare a symbol; order is irrelevant
+//   reel <1-3> <name|name*k> ...   the stops of one reel strip, in order
+//   pay three <name|any> <mult>    all three reels show the symbol
+//   pay pair <name|any> <mult>     at least two reels show the same symbol
+//   pay count <name> <n> <mult>    at least n reels show the symbol
+//   progressive <rate> <seed>      the first pay line wins the shared jackpot pool
+//                                  instead; every bet feeds it rate x bet
+// Pay lines are checked top to bottom and the first match pays, so list the
+// biggest prizes first. Multipliers are stake + winnings, as processWin expects.
+struct SlotRule {
+    enum Kind { Three, Pair, Count };
+    Kind kind = Three;
+    int symbol = -1;  // -1 = any symbol
+    int count = 3;
+    double multiplier = 0.0;
+};
+
+struct SlotConfig {
+    static constexpr int reelCount = 3;
+
+    std::vector<std::string> names;
+    std::vector<std::string> glyphs;
+    std::vector<uint8_t> strips[reelCount];
+    std::vector<SlotRule> rules;
+    std::vector<int16_t> ruleFor; // [a][b][c] symbol triple -> first matching rule, -1 for none
+    double progressiveRate = 0.0;  // 0 = no progressive; rule 0 pays its multiplier
+    double progressiveSeed = 0.0;
+
+    bool progressive() const { return progressiveRate > 0.0; }
+    bool isJackpot(int rule) const { return rule == 0 && progressive(); }
+
+    int symbolCount() const { return static_cast<int>(names.size()); }
+    uint64_t stopCombinations() const {
+        uint64_t n = 1;
+        for (const auto& s : strips) n *= s.size();
+        return n;
+    }
+
+    int findSymbol(const std::string& name) const {
+        for (size_t i = 0; i < names.size(); ++i) if (names[i] == name) return static_cast<int>(i);
+        return -1;
+    }
+
+    // First rule matching the symbols a, b, c, or -1
+    int evaluate(int a, int b, int c) const {
+        return ruleFor[(static_cast<size_t>(a) * names.size() + b) * names.size() + c];
+    }
+
+    std::string describe(int rule) const {
+        const SlotRule& r = rules[rule];
+        const std::string sym = r.symbol < 0 ? "any" : glyphs[r.symbol];
+        if (r.kind == SlotRule::Three) return "Three " + sym;
+        if (r.kind == SlotRule::Pair) return "Pair of " + sym;
+        return std::to_string(r.count) + "+ " + sym;
+    }
+
+    // Builds the rule lookup; call once after symbols, strips and rules are in place
+    bool finalize(std::string& error) {
+        if (names.empty()) { error = "no symbols declared"; return false; }
+        if (names.size() > 64) { error = "at most 64 symbols are supported"; return false; }
+        for (int r = 0; r < reelCount; ++r) {
+            if (strips[r].empty()) { error = "reel " + std::to_string(r + 1) + " has no stops"; return false; }
+        }
+        if (rules.empty()) { error = "no pay lines"; return false; }
+
+        const int n = symbolCount();
+        ruleFor.assign(static_cast<size_t>(n) * n * n, -1);
+        for (int a = 0; a < n; ++a)
+            for (int b = 0; b < n; ++b)
+                for (int c = 0; c < n; ++c) {
+                    for (size_t i = 0; i < rules.size(); ++i) {
+                        if (matches(rules[i], a, b, c)) {
+                            ruleFor[(static_cast<size_t>(a) * n + b) * n + c] = static_cast<int16_t>(i);
+                            break;
+                        }
+                    }
+                }
+        return true;
+    }
+
+    // The original machine: six symbols, one stop each, three of a kind 11x, any pair 2x
+    static SlotConfig classic() {
+        SlotConfig cfg;
+        cfg.names = { "cherry", "lemon", "bell", "diamond", "seven", "star" };
+        cfg.glyphs = { u8"🍒", u8"🍋", u8"🔔", u8"💎", u8"7️⃣", u8"⭐" };
+        for (auto& s : cfg.strips) s = { 0, 1, 2, 3, 4, 5 };
+        cfg.rules.push_back(SlotRule{ SlotRule::Three, -1, 3, 11.0 });
+        cfg.rules.push_back(SlotRule{ SlotRule::Pair, -1, 2, 2.0 });
+        std::string ignored;
+        cfg.finalize(ignored);
+        return cfg;
+    }
+
+private:
+    static bool matches(const SlotRule& r, int a, int b, int c) {
+        switch (r.kind) {
+        case SlotRule::Three:
+            return a == b && b == c && (r.symbol < 0 || a == r.symbol);
+        case SlotRule::Pair:
+            if (r.symbol < 0) return a == b || b == c || a == c;
+            return (a == r.symbol) + (b == r.symbol) + (c == r.symbol) >= 2;
+        case SlotRule::Count:
+            return (a == r.symbol) + (b == r.symbol) + (c == r.symbol) >= r.count;
+        }
+        return false;
+    }
+};
+
+// Returns false with a "line N: ..." message if the file is missing or malformed
+bool loadSlotConfig(const std::string& path, SlotConfig& out, std::string& error) {
+    std::ifstream in(path);
+    if (!in) { error = "cannot open " + path; return false; }
+
+    SlotConfig cfg;
+    std::vector<std::pair<std::string, int>> reelTokens[SlotConfig::reelCount]; // token, line
+    std::vector<std::vector<std::string>> payLines;
+    std::vector<int> payLineNumbers;
+    std::string line;
+    int lineNo = 0;
+
+    auto fail = [&](int at, const std::string& msg) {
+        error = path + " line " + std::to_string(at) + ": " + msg;
+        return false;
+    };
+
+    // Symbols may be declared after the reels that use them, so resolve names in a second pass
+    while (std::getline(in, line)) {
+        ++lineNo;
+        const size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+        std::istringstream iss(line);
+        std::vector<std::string> tok;
+        for (std::string t; iss >> t; ) tok.push_back(t);
+        if (tok.empty()) continue;
+
+        if (tok[0] == "symbol") {
+            if (tok.size() != 3) return fail(lineNo, "expected: symbol <name> <glyph>");
+            if (cfg.findSymbol(tok[1]) >= 0) return fail(lineNo, "symbol '" + tok[1] + "' declared twice");
+            if (tok[1] == "any") return fail(lineNo, "'any' is reserved");
+            cfg.names.push_back(tok[1]);
+            cfg.glyphs.push_back(tok[2]);
+        }
+        else if (tok[0] == "reel") {
+            const int r = (tok.size() >= 2) ? std::atoi(tok[1].c_str()) : 0;
+            if (r < 1 || r > SlotConfig::reelCount) return fail(lineNo, "reel number must be 1-3");
+            for (size_t i = 2; i < tok.size(); ++i) reelTokens[r - 1].emplace_back(tok[i], lineNo);
+        }
+        else if (tok[0] == "pay") {
+            payLines.push_back(tok);
+            payLineNumbers.push_back(lineNo);
+        }
+        else if (tok[0] == "progressive") {
+            if (tok.size() != 3) return fail(lineNo, "expected: progressive <rate> <seed>");
+            cfg.progressiveRate = std::atof(tok[1].c_str());
+            cfg.progressiveSeed = std::atof(tok[2].c_str());
+            if (!(cfg.progressiveRate > 0.0 && cfg.progressiveRate < 0.5)) return fail(lineNo, "progressive rate must be between 0 and 0.5");
+            if (cfg.progressiveSeed < 0.0) return fail(lineNo, "progressive seed can't be negative");
+        }
+        else return fail(lineNo, "unknown directive '" + tok[0] + "'");
+    }
+
+    for (int r = 0; r < SlotConfig::reelCount; ++r) {
+        for (const auto& entry : reelTokens[r]) {
+            const int where = entry.second;
+            std::string name = entry.first;
+            int repeat = 1;
+            const size_t star = name.find('*');
+            if (star != std::string::npos) {
+                repeat = std::atoi(name.c_str() + star + 1);
+                name.erase(star);
+                if (repeat < 1 || repeat > 1000) return fail(where, "bad repeat count for '" + name + "'");
+            }
+            const int s = cfg.findSymbol(name);
+            if (s < 0) return fail(where, "unknown symbol '" + name + "'");
+            cfg.strips[r].insert(cfg.strips[r].end(), static_cast<size_t>(repeat), static_cast<uint8_t>(s));
+        }
+    }
+
+    for (size_t i = 0; i < payLines.size(); ++i) {
+        const auto& tok = payLines[i];
+        const int where = payLineNumbers[i];
+        SlotRule rule;
+        size_t multAt = 3;
+        if (tok.size() >= 2 && tok[1] == "three") rule.kind = SlotRule::Three;
+        else if (tok.size() >= 2 && tok[1] == "pair") { rule.kind = SlotRule::Pair; rule.count = 2; }
+        else if (tok.size() >= 2 && tok[1] == "count") { rule.kind = SlotRule::Count; multAt = 4; }
+        else return fail(where, "expected: pay three|pair|count ...");
+        if (tok.size() != multAt + 1) return fail(where, "wrong number of fields for pay " + tok[1]);
+
+        if (tok[2] == "any" && rule.kind != SlotRule::Count) rule.symbol = -1;
+        else {
+            rule.symbol = cfg.findSymbol(tok[2]);
+            if (rule.symbol < 0) return fail(where, "unknown symbol '" + tok[2] + "'");
+        }
+        if (rule.kind == SlotRule::Count) {
+            rule.count = std::atoi(tok[3].c_str());
+            if (rule.count < 1 || rule.count > SlotConfig::reelCount) return fail(where, "count must be 1-3");
+        }
+        rule.multiplier = std::atof(tok[multAt].c_str());
+        if (!(rule.multiplier > 0.0)) return fail(where, "multiplier must be positive");
+        cfg.rules.push_back(rule);
+    }
+
+    if (!cfg.finalize(error)) { error = path + ": " + error; return false; }
+    out = std::move(cfg);
+    return true;
+}
+
+//------Batched spins-------//
+// Draws n spins in one pass with no output; out[i] is the paying rule or -1.
+// Used by auto-spin and the Monte Carlo check, so both see the same machine.
+template <typename Gen>
+void spinSlotBatch(const SlotConfig& cfg, Gen& gen, size_t n, std::vector<int16_t>& out) {
+    std::uniform_int_distribution<int> stop[SlotConfig::reelCount];
+    for (int r = 0; r < SlotConfig::reelCount; ++r)
+        stop[r] = std::uniform_int_distribution<int>(0, static_cast<int>(cfg.strips[r].size()) - 1);
+
+    out.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        const int a = cfg.strips[0][stop[0](gen)];
+        const int b = cfg.strips[1][stop[1](gen)];
+        const int c = cfg.strips[2][stop[2](gen)];
+        out[i] = static_cast<int16_t>(cfg.evaluate(a, b, c));
+    }
+}
+
+//================== Slots RTP Engine ==================//
+//------Exact return by enumerating every stop combination-------//
+// Stops showing the same symbol pay identically, so the enumeration runs over
+// symbol triples weighted by how many stops each reel has for that symbol. That
+// covers all L1*L2*L3 stop combinations exactly in symbols^3 steps.
+struct SlotRtpReport {
+    uint64_t combinations = 0;
+    uint64_t hits = 0;
+    double rtp = 0.0;
+    double hitFrequency = 0.0;
+    double stdDev = 0.0;                  // per unit bet, for sizing Monte Carlo runs
+    std::vector<uint64_t> ruleHits;
+    std::vector<double> ruleContribution; // share of RTP per pay line
+    // With a progressive, rule 0 is excluded above; over time it returns every
+    // contribution plus the seed once per hit
+    double jackpotProbability = 0.0;
+    double progressiveRtp(double bet, double rate, double seed) const {
+        return rate + jackpotProbability * seed / bet;
+    }
+};
+
+SlotRtpReport computeSlotRtp(const SlotConfig& cfg) {
+    const int n = cfg.symbolCount();
+    std::vector<uint64_t> weight[SlotConfig::reelCount];
+    for (int r = 0; r < SlotConfig::reelCount; ++r) {
+        weight[r].assign(n, 0);
+        for (uint8_t s : cfg.strips[r]) ++weight[r][s];
+    }
+
+    SlotRtpReport rep;
+    rep.combinations = cfg.stopCombinations();
+    rep.ruleHits.assign(cfg.rules.size(), 0);
+    rep.ruleContribution.assign(cfg.rules.size(), 0.0);
+
+    for (int a = 0; a < n; ++a) {
+        if (!weight[0][a]) continue;
+        for (int b = 0; b < n; ++b) {
+            const uint64_t wab = weight[0][a] * weight[1][b];
+            if (!wab) continue;
+            for (int c = 0; c < n; ++c) {
+                const uint64_t w = wab * weight[2][c];
+                const int rule = cfg.evaluate(a, b, c);
+                if (!w || rule < 0) continue;
+                rep.ruleHits[rule] += w;
+            }
+        }
+    }
+
+    const double total = static_cast<double>(rep.combinations);
+    double secondMoment = 0.0;
+    for (size_t i = 0; i < cfg.rules.size(); ++i) {
+        const double p = rep.ruleHits[i] / total;
+        const double m = cfg.isJackpot(static_cast<int>(i)) ? 1.0 : cfg.rules[i].multiplier; // jackpot refunds the stake
+        if (cfg.isJackpot(static_cast<int>(i))) rep.jackpotProbability = p;
+        rep.hits += rep.ruleHits[i];
+        rep.ruleContribution[i] = p * m;
+        rep.rtp += p * m;
+        secondMoment += p * m * m;
+    }
+    rep.hitFrequency = rep.hits / total;
+    rep.stdDev = std::sqrt(std::max(0.0, secondMoment - rep.rtp * rep.rtp));
+    return rep;
+}
+
+//------Monte Carlo cross-check on the job scheduler, one generator per chunk-------//
+// Progressive hits count as a stake refund here, matching computeSlotRtp
+struct SlotMonteCarlo {
+    uint64_t spins = 0;
+    uint64_t hits = 0;
+    double returned = 0.0;
+    unsigned threads = 0;
+
+    double rtp() const { return spins ? returned / spins : 0.0; }
+};
+
+SlotMonteCarlo monteCarloSlots(const SlotConfig& cfg, uint64_t spins, uint32_t seed, JobScheduler& jobs = jobScheduler()) {
+    SlotMonteCarlo total = jobs.parallelReduce(spins, 1u << 18, SlotMonteCarlo(),
+        [&cfg, seed](const JobScheduler::Slice& s) {
+            std::mt19937 gen(s.seed(seed));
+            std::vector<int16_t> batch;
+            SlotMonteCarlo local;
+            for (uint64_t done = 0; done < s.size(); ) {
+                const size_t n = static_cast<size_t>(std::min<uint64_t>(s.size() - done, 4096));
+                spinSlotBatch(cfg, gen, n, batch);
+                for (int16_t rule : batch) {
+                    if (rule >= 0) { ++local.hits; local.returned += cfg.isJackpot(rule) ? 1.0 : cfg.rules[rule].multiplier; }
+                }
+                done += n;
+            }
+            local.spins = s.size();
+            return local;
+        },
+        [](SlotMonteCarlo& t, const SlotMonteCarlo& p) {
+            t.spins += p.spins;
+            t.hits += p.hits;
+            t.returned += p.returned;
+        });
+    total.threads = jobs.threads();
+    return total;
+}
+
+//================== Auto-Spin ==================//
+//------Quiet settlement of a pre-drawn batch, shared by every slot machine-------//
+struct AutoSpinPlan {
+    double bet = 0.0;      // total stake per spin
+    int spins = 0;
+    double stopLoss = 0.0; // 0 = no limit
+    ProgressiveJackpot* jackpot = nullptr; // fed jackpotRate x bet per spin when set
+    double jackpotRate = 0.0;
+};
+
+// Multiplier marking a spin that wins the progressive pool
+constexpr double autoSpinJackpot = -1.0;
+
+Task<AutoSpinPlan> readAutoSpinPlan(InputSource& input, double bet) {
+    AutoSpinPlan plan;
+    plan.bet = bet;
+    plan.spins = co_await input.readInt("Number of spins (1-100000): ", 1, 100000);
+    plan.stopLoss = co_await input.readDouble(u8"Stop once net loss reaches (£, 0 = no limit): ", 0, 1e9);
+    co_return plan;
+}
+
+// multipliers[i] is spin i's return per unit bet (0 = loss, autoSpinJackpot = claim
+// the pool; the amount is only known when the spin settles). Stops early when the
+// balance can't cover a spin or the stop-loss is reached, then shows one summary.
+template <typename View>
+void settleAutoSpins(const View& view, Player& player, CasinoManager& casino, const AutoSpinPlan& plan,
+                     const std::vector<double>& multipliers, std::chrono::steady_clock::time_point start) {
+    const double bet = plan.bet;
+    int played = 0, wins = 0, cursesGained = 0, jackpots = 0;
+    double wagered = 0.0, won = 0.0, biggestWin = 0.0;
+    std::string stopReason = "Completed all spins.";
+    for (double mult : multipliers) {
+        if (!player.canCover(bet)) { stopReason = "Stopped: balance too low for another spin."; break; }
+        if (plan.stopLoss > 0.0 && wagered - won >= plan.stopLoss) { stopReason = "Stopped: stop-loss reached."; break; }
+
+        player.placeBet(bet);
+        player.clearCurrentBet();
+        wagered += bet;
+        ++played;
+        if (plan.jackpot) {
+            plan.jackpot->contribute(bet * plan.jackpotRate);
+            if (mult == autoSpinJackpot) {
+                mult = 1.0 + plan.jackpot->claim() / bet;
+                ++jackpots;
+            }
+        }
+        if (mult > 0.0) {
+            casino.processWin(bet, mult, false);
+            won += bet * mult;
+            biggestWin = std::max(biggestWin, bet * mult);
+            ++wins;
+        }
+        else {
+            cursesGained += maybeApplyRandomCurseAfterLoss(player, false);
+            casino.processLoss(bet, false);
+        }
+        player.regenerateMana();
+        player.decayCurses(false);
+        player.clearBlessings();
+    }
+
+    view.draw([&](FrameBuffer& out) {
+        const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(2);
+        oss << "AUTO-SPIN SUMMARY\n";
+        oss << "Spins: " << played << " of " << plan.spins << " (" << wins << " paid)\n";
+        oss << u8"Total wagered: £" << wagered << u8"  Total won: £" << won << "\n";
+        oss << (won >= wagered ? u8"Net gain: £" : u8"Net loss: £") << std::fabs(won - wagered) << "\n";
+        oss << u8"Biggest win: £" << biggestWin << "\n";
+        if (plan.jackpot) oss << "Progressive jackpots won: " << jackpots << u8"  (pool now £" << plan.jackpot->value() << ")\n";
+        oss << "Curses gained: " << cursesGained << "\n";
+        oss << u8"Balance: £" << player.getBalance() << "\n";
+        oss << stopReason << std::setprecision(0) << "  (" << (secs > 0.0 ? played / secs : 0.0) << " spins/s)";
+        drawAsciiBox(out, oss.str());
+    });
+    view.status(player);
+}
@@ -1,31 +1,36 @@
 ﻿#pragma once
-#include <thread>
-#include <chrono>
 #include "Main.h"
+#include "Animation.h"
 
-void openSplashScreen(const std::string& title) {
-    system("cls");
+inline Task<void> openSplashScreen(const std::string& title) {
+    terminal().clear();
     drawAsciiBox(title);
     drawAsciiBox("Loading");
-    std::this_thread::sleep_for(std::chrono::milliseconds(1500)); // pause 1.5s
-    system("cls");
+    co_await animator().hold(1500); // pause 1.5s, or until a key
+    terminal().clear();
 }
-void exitSplashScreen(const std::string& title) {
-    system("cls");
+inline Task<void> exitSplashScreen(const std::string& title) {
+    terminal().clear();
     drawAsciiBox(title);
     drawAsciiBox("Thank you for playing! Goodbye!\n");
-    std::this_thread::sleep_for(std::chrono::milliseconds(1500)); // pause 1.5s
-    system("cls");
+    co_await animator().hold(1500); // pause 1.5s, or until a key
+    terminal().clear();
 }
 
-static void slowPrint(const std::string& text, int delay = 20) {
-    for (char c : text) {
-        std::cout << c << std::flush;
-        std::this_thread::sleep_for(std::chrono::milliseconds(delay));
-    }
+// Types the text out one character per frame
+inline Task<void> slowPrint(const std::string& text, int delay = 20) {
+    const std::string_view all = text;
+    co_await animator().run(static_cast<int>(utf8_codepoints(all)), [&](FrameBuffer& out, int i) {
+        size_t end = 0;
+        for (int shown = 0; end < all.size(); ++end) {
+            if ((static_cast<unsigned char>(all[end]) & 0xC0) != 0x80 && shown++ > i) break;
+        }
+        out << all.substr(0, end);
+        return delay;
+    });
 }
 
-static void animateDice() {
+inline Task<void> animateDice() {
     std::vector<std::string> frames = {
         u8"●     ",
         u8"● ●   ",
@@ -35,18 +40,18 @@ static void animateDice() {
         u8"     ●"
     };
 
-    for (int i = 0; i < 10; i++) {
-        std::cout << "\rDice rolling: " << frames[i % frames.size()] << std::flush;
-        std::this_thread::sleep_for(std::chrono::milliseconds(120));
-    }
+    co_await animator().run(10, [&](FrameBuffer& out, int i) {
+        out << "Dice rolling: " << frames[i % frames.size()];
+        return 120;
+    });
 }
 
-static void playSplashScreen(const std::string& title) {
-    system("cls");
+inline Task<void> playSplashScreen(const std::string& title) {
+    terminal().clear();
     drawAsciiBox(title);
     drawAsciiBox("Loading");
 
-    slowPrint(u8R"(
+    co_await slowPrint(u8R"(
 
 
 
@@ -70,13 +75,12 @@ static void playSplashScreen(const std::string& title) {
         ♦   ♣   ♠   ♥               ♥   ♦   ♣   ♠ 
     )");
 
-    animateDice();
-    std::cout << "\n";
+    co_await animateDice();
 
-    std::this_thread::sleep_for(std::chrono::milliseconds(400));
+    co_await animator().hold(400);
 }
 
-void animateRouletteWheel() {
+inline Task<void> animateRouletteWheel() {
     std::vector<std::string> frames = {
         "  [ 0 ]  32  15  19  4  21  2  25  17  ",
         "  17  [ 0 ]  32  15  19  4  21  2  25  ",
@@ -88,15 +92,13 @@ void animateRouletteWheel() {
         "  15  19  4   21  2   25  17  [ 0 ]  32"
     };
 
-    for (int i = 0; i < 16; i++) {
-        std::cout << "\rSpinning wheel: " << frames[i % frames.size()] << std::flush;
-        std::this_thread::sleep_for(std::chrono::milliseconds(120));
-    }
-
-    std::cout << "\n";
+    co_await animator().run(16, [&](FrameBuffer& out, int i) {
+        out << "Spinning wheel: " << frames[i % frames.size()];
+        return 120;
+    });
 }
 
-void animateRouletteBall() {
+inline Task<void> animateRouletteBall() {
     std::vector<std::string> ball = {
         "Ball: ○-------------",
         "Ball: ----○---------",
@@ -108,33 +110,31 @@ void animateRouletteBall() {
         "Ball: -----------○---"
     };
 
-    for (int i = 0; i < 12; i++) {
-        std::cout << "\r" << ball[i % ball.size()] << std::flush;
-        std::this_thread::sleep_for(std::chrono::milliseconds(140));
-    }
-
-    std::cout << "\n";
+    co_await animator().run(12, [&](FrameBuffer& out, int i) {
+        out << ball[i % ball.size()];
+        return 140;
+    });
 }
 
-void playRouletteSplash(const std::string& title) {
-    system("cls");
+inline Task<void> playRouletteSplash(const std::string& title) {
+    terminal().clear();
 
-    slowPrint("====================================\n", 2);
-    slowPrint("           " + title + "\n", 5);
-    slowPrint("====================================\n\n", 2);
+    co_await slowPrint("====================================\n", 2);
+    co_await slowPrint("           " + title + "\n", 5);
+    co_await slowPrint("====================================\n\n", 2);
 
-    slowPrint("         W H E E L   S P I N N I N G\n\n", 10);
+    co_await slowPrint("         W H E E L   S P I N N I N G\n\n", 10);
 
     // Wheel animation
-    animateRouletteWheel();
-    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    co_await animateRouletteWheel();
+    co_await animator().hold(200);
 
     // Ball animation
-    animateRouletteBall();
+    co_await animateRouletteBall();
     std::cout << "\n";
 
     // Fancy roulette ASCII
-    slowPrint(R"(
+    co_await slowPrint(R"(
               ┌──────────────────────────┐
               │   0  32  15  19  4  21   │
               │  2  25  17  34  6  27    │
@@ -145,6 +145,6 @@ void playRouletteSplash(const std::string& title) {
 
     std::cout << "\n";
 
-    std::this_thread::sleep_for(std::chrono::milliseconds(200));
-    system("cls");
+    co_await animator().hold(200);
+    terminal().clear();
 }
\ No newline at end of file
@@ -0,0 +1,202 @@
+﻿#pragma once
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Renderer.h"
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+//================== Terminal Backend ==================//
+//------ANSI screen control that only repaints what changed-------//
+// clear() blanks the screen with an escape sequence, not a shell. show() draws a
+// region in place: it remembers the rows it drew last time, moves the cursor
+// back over them and rewrites only the cells that differ, so an animation
+// frame costs a few bytes instead of a full repaint. The region ends with
+// release(), after which ordinary output carries on below it.
+//
+// When stdout is not an ANSI terminal (a pipe, a file, a console without
+// VT support) nothing is repainted: clear() is a no-op and a region is
+// written once, as plain text, when it is released.
+class Terminal {
+public:
+    Terminal() : ansi(detectAnsi()) {}
+    // A terminal that is known to be (or not be) ANSI, e.g. a server session's plain text
+    explicit Terminal(bool ansi) : ansi(ansi) {}
+
+    bool isAnsi() const { return ansi; }
+
+    // Height of the visible window in rows (24 when it cannot be asked)
+    static size_t windowRows() {
+#ifdef _WIN32
+        CONSOLE_SCREEN_BUFFER_INFO info;
+        if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info)) {
+            return static_cast<size_t>(info.srWindow.Bottom - info.srWindow.Top + 1);
+        }
+#else
+        winsize ws{};
+        if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_row > 0) return ws.ws_row;
+#endif
+        return 24;
+    }
+
+    // Blank the screen and home the cursor
+    void clear() {
+        rows.clear();
+        pending.clear();
+        if (!ansi) return;
+        wire << "\x1b[H\x1b[2J\x1b[3J";
+        wire.present();
+    }
+
+    // Draw `frame` over the previous contents of the current region
+    void show(FrameBuffer& frame) {
+        show(frame.view());
+        frame.clear();
+    }
+
+    void show(std::string_view text) {
+        if (!ansi) {
+            pending.assign(text.data(), text.size());
+            return;
+        }
+        const size_t oldCount = rows.size();
+        // A region taller than the window has scrolled past the top and
+        // cannot be reached again; start a new one below it
+        if (oldCount >= windowRows()) rows.clear();
+        if (!rows.empty()) wire << "\x1b[" << static_cast<int>(rows.size()) << "A\r";
+
+        size_t row = 0, cursor = 0;
+        for (size_t pos = 0; pos < text.size(); ++row) {
+            size_t end = text.find('\n', pos);
+            if (end == std::string_view::npos) end = text.size();
+            const std::string_view line = text.substr(pos, end - pos);
+            pos = end + 1;
+            if (row < rows.size() && rows[row] == line) continue;
+
+            size_t byte = 0, column = 0;
+            if (row < rows.size()) firstDifference(rows[row], line, byte, column);
+            for (; cursor < row; ++cursor) wire << '\n';
+            wire << '\r';
+            if (column) wire << "\x1b[" << static_cast<int>(column) << 'C';
+            wire << line.substr(byte) << "\x1b[K";
+
+            if (row < rows.size()) rows[row].assign(line.data(), line.size());
+            else rows.emplace_back(line);
+        }
+        // Step below the region and wipe any rows the old frame had beyond it
+        const size_t newCount = row;
+        for (; cursor < newCount; ++cursor) wire << '\n';
+        wire << '\r';
+        if (newCount < oldCount) wire << "\x1b[J";
+        rows.resize(newCount);
+        wire.present();
+    }
+
+    // End the current region; the next show() starts a fresh one at the cursor
+    void release() {
+        rows.clear();
+        if (ansi || pending.empty()) return;
+        wire << pending;
+        if (pending.back() != '\n') wire << '\n';
+        pending.clear();
+        wire.present();
+    }
+
+private:
+    const bool ansi;
+    FrameBuffer wire;              // escape sequences plus changed cells
+    std::vector<std::string> rows; // what the current region shows now
+    std::string pending;           // last frame, for plain output
+
+    // First byte where the rows differ, backed up to the start of a character
+    // (a code point and the marks combined with it), and the screen column it
+    // sits in. Emoji and CJK take two columns. Terminals disagree on how wide
+    // a sequence built with a variation selector, a keycap or a joiner is
+    // (7️⃣ is one column in some, two in others), so a prefix holding one is
+    // not trusted and the row is redrawn from the left edge.
+    static void firstDifference(std::string_view was, std::string_view now, size_t& byte, size_t& column) {
+        size_t i = 0;
+        const size_t n = was.size() < now.size() ? was.size() : now.size();
+        while (i < n && was[i] == now[i]) ++i;
+        while (i > 0 && i < now.size() && (static_cast<unsigned char>(now[i]) & 0xC0) == 0x80) --i;
+        while (i > 0 && i < now.size()) {
+            size_t at = i;
+            if (cellWidth(decode(now, at)) != 0) break;
+            do --i;
+            while (i > 0 && (static_cast<unsigned char>(now[i]) & 0xC0) == 0x80);
+        }
+        byte = i;
+        column = 0;
+        for (size_t k = 0; k < i;) {
+            const uint32_t cp = decode(now, k);
+            if (cp == 0xFE0F || cp == 0x20E3 || cp == 0x200D) {
+                byte = 0;
+                column = 0;
+                return;
+            }
+            column += cellWidth(cp);
+        }
+    }
+
+    // The code point at `at`, which moves past it; a stray byte is taken as itself
+    static uint32_t decode(std::string_view s, size_t& at) {
+        const unsigned char b = static_cast<unsigned char>(s[at++]);
+        const int extra = b >= 0xF0 ? 3 : b >= 0xE0 ? 2 : b >= 0xC0 ? 1 : 0;
+        uint32_t cp = extra ? b & (0x3F >> extra) : b;
+        for (int k = 0; k < extra && at < s.size() && (static_cast<unsigned char>(s[at]) & 0xC0) == 0x80; ++k)
+            cp = cp << 6 | (static_cast<unsigned char>(s[at++]) & 0x3F);
+        return cp;
+    }
+
+    // Columns a code point takes: 0 for combining marks and selectors, 2 for
+    // East Asian wide characters and emoji, 1 otherwise
+    static size_t cellWidth(uint32_t cp) {
+        if (cp < 0x300) return 1;
+        if ((cp >= 0x300 && cp <= 0x36F) || (cp >= 0x200B && cp <= 0x200F) || (cp >= 0x20D0 && cp <= 0x20FF) ||
+            (cp >= 0xFE00 && cp <= 0xFE0F) || (cp >= 0x1F3FB && cp <= 0x1F3FF) || (cp >= 0xE0020 && cp <= 0xE007F)) return 0;
+        static const uint32_t wide[][2] = {
+            { 0x1100, 0x115F }, { 0x231A, 0x231B }, { 0x2329, 0x232A }, { 0x23E9, 0x23EC }, { 0x23F0, 0x23F0 },
+            { 0x23F3, 0x23F3 }, { 0x25FD, 0x25FE }, { 0x2614, 0x2615 }, { 0x2648, 0x2653 }, { 0x267F, 0x267F },
+            { 0x2693, 0x2693 }, { 0x26A1, 0x26A1 }, { 0x26AA, 0x26AB }, { 0x26BD, 0x26BE }, { 0x26C4, 0x26C5 },
+            { 0x26CE, 0x26CE }, { 0x26D4, 0x26D4 }, { 0x26EA, 0x26EA }, { 0x26F2, 0x26F3 }, { 0x26F5, 0x26F5 },
+            { 0x26FA, 0x26FA }, { 0x26FD, 0x26FD }, { 0x2705, 0x2705 }, { 0x270A, 0x270B }, { 0x2728, 0x2728 },
+            { 0x274C, 0x274C }, { 0x274E, 0x274E }, { 0x2753, 0x2755 }, { 0x2757, 0x2757 }, { 0x2795, 0x2797 },
+            { 0x27B0, 0x27B0 }, { 0x27BF, 0x27BF }, { 0x2B1B, 0x2B1C }, { 0x2B50, 0x2B50 }, { 0x2B55, 0x2B55 },
+            { 0x2E80, 0x303E }, { 0x3041, 0x33FF }, { 0x3400, 0x4DBF }, { 0x4E00, 0x9FFF }, { 0xA000, 0xA4CF },
+            { 0xAC00, 0xD7A3 }, { 0xF900, 0xFAFF }, { 0xFE10, 0xFE19 }, { 0xFE30, 0xFE6F }, { 0xFF00, 0xFF60 },
+            { 0xFFE0, 0xFFE6 }, { 0x1F004, 0x1F004 }, { 0x1F0CF, 0x1F0CF }, { 0x1F18E, 0x1F18E }, { 0x1F191, 0x1F19A },
+            { 0x1F200, 0x1F251 }, { 0x1F300, 0x1F64F }, { 0x1F680, 0x1F6FF }, { 0x1F7E0, 0x1F7EB }, { 0x1F90C, 0x1F9FF },
+            { 0x1FA70, 0x1FAFF }, { 0x20000, 0x3FFFD },
+        };
+        for (const auto& r : wide) {
+            if (cp < r[0]) break;
+            if (cp <= r[1]) return 2;
+        }
+        return 1;
+    }
+
+    static bool detectAnsi() {
+#ifdef _WIN32
+        HANDLE out = GetStdHandle(STD_OUTPUT_HANDLE);
+        DWORD mode = 0;
+        if (out == INVALID_HANDLE_VALUE || !GetConsoleMode(out, &mode)) return false;
+        return SetConsoleMode(out, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING) != 0;
+#else
+        const char* term = std::getenv("TERM");
+        return isatty(STDOUT_FILENO) && term && std::string_view(term) != "dumb";
+#endif
+    }
+};
+
+// The console, or the terminal of the server session running on this thread
+inline Terminal& terminal() {
+    if (Terminal* t = sessionContext().terminal) return *t;
+    static Terminal t;
+    return t;
+}
@@ -0,0 +1,328 @@
+﻿#pragma once
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "Coroutine.h"
+
+//================== Trace ==================//
+//------Timeline of a run-------//
+// With --trace <file>, scoped spans (a round, a game's play, a betting round,
+// the showdown, the dealer's turn, a rendered frame, a scheduler chunk) are
+// written as Chrome trace events, to open in ui.perfetto.dev or
+// chrome://tracing. Spans on the console and in the simulators sit on their
+// thread's timeline; a server session's sit on one of their own, since many
+// sessions take turns on each worker. With tracing off a span is one load.
+struct TraceEvent {
+    const char* name; // a literal
+    int64_t start;    // nanoseconds since the trace was opened
+    int64_t duration;
+    int track;        // session track, 0 for the thread's own
+    char detail[36];  // copied, so it may come from a temporary; truncated
+};
+
+inline int64_t traceClock() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//------One thread's spans-------//
+// A single-producer ring: the owning thread fills slots and publishes them
+// with one release store; the writer thread reads them and hands the slots
+// back the same way. Neither side waits for the other. A full ring drops the
+// span and counts it.
+class TraceRing {
+public:
+    static constexpr uint64_t capacity = 1 << 14; // 1 MiB
+
+    explicit TraceRing(unsigned thread) : thread(thread) {}
+
+    // Owning thread only; true every quarter ring, when the writer should look
+    bool push(const TraceEvent& e) {
+        const uint64_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == capacity) {
+            dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+        slots[h & (capacity - 1)] = e;
+        head.store(h + 1, std::memory_order_release);
+        return ((h + 1) & (capacity / 4 - 1)) == 0;
+    }
+
+    // Writer thread only: f(event) for everything published so far
+    template <typename F>
+    void drain(const F& f) {
+        const uint64_t t = tail.load(std::memory_order_relaxed);
+        const uint64_t h = head.load(std::memory_order_acquire);
+        for (uint64_t i = t; i != h; ++i) f(slots[i & (capacity - 1)]);
+        tail.store(h, std::memory_order_release);
+    }
+
+    const unsigned thread;                // tid in the file
+    std::atomic<bool> finished{ false };  // the thread has ended
+    std::atomic<uint64_t> dropped{ 0 };
+
+private:
+    alignas(64) std::atomic<uint64_t> head{ 0 };
+    alignas(64) std::atomic<uint64_t> tail{ 0 };
+    TraceEvent slots[capacity];
+};
+
+class TraceLog;
+inline TraceLog& traceLog();
+
+//------Writer-------//
+// Drains every ring on its own thread every few milliseconds, or sooner when
+// a ring is filling, and appends the events to the file. Spans that were
+// dropped show as a counter track. The file is finished by close(), which
+// also runs at exit.
+class TraceLog {
+public:
+    static constexpr auto interval = std::chrono::milliseconds(20);
+
+    bool open(const std::string& path, std::string& error) {
+        close();
+        file = std::fopen(path.c_str(), "wb");
+        if (!file) {
+            error = "Cannot open trace file: " + path;
+            return false;
+        }
+        origin = traceClock();
+        separator = "";
+        pending.clear();
+        reportedDrops = 0;
+        namedTracks.clear();
+        std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", file);
+        meta("process_name", 1, 0, "Casino");
+        meta("process_name", 2, 0, "Sessions");
+        stopping = false;
+        writer = std::thread([this]() { run(); });
+        static const bool registered = std::atexit([]() { traceLog().close(); }) == 0;
+        (void)registered;
+        active.store(true, std::memory_order_release);
+        return true;
+    }
+
+    bool isOpen() const { return file != nullptr; }
+    bool enabled() const { return active.load(std::memory_order_relaxed); }
+
+    // Stops the writer, writes what is left and completes the JSON
+    void close() {
+        if (!file) return;
+        active.store(false, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            stopping = true;
+        }
+        wakeup.notify_one();
+        writer.join();
+        drain();
+        std::fputs("\n]}\n", file);
+        std::fclose(file);
+        file = nullptr;
+    }
+
+    void record(TraceRing& ring, const TraceEvent& e) {
+        if (ring.push(e)) wakeup.notify_one();
+    }
+
+    int64_t since(int64_t t) const { return t - origin; }
+
+    TraceRing* attach() {
+        std::lock_guard<std::mutex> lock(ringMutex);
+        rings.push_back(std::make_unique<TraceRing>(static_cast<unsigned>(rings.size() + retired + 1)));
+        return rings.back().get();
+    }
+
+    // The thread is ending; its ring is freed once the writer has emptied it
+    void detach(TraceRing* ring) { ring->finished.store(true, std::memory_order_release); }
+
+private:
+    std::FILE* file = nullptr;
+    std::atomic<bool> active{ false };
+    int64_t origin = 0;
+    std::thread writer;
+    std::mutex wakeMutex;
+    std::condition_variable wakeup;
+    bool stopping = false;
+
+    std::mutex ringMutex; // held to add a ring, and by the writer while draining
+    std::vector<std::unique_ptr<TraceRing>> rings;
+    size_t retired = 0;
+
+    // Writer thread only
+    const char* separator = "";
+    uint64_t reportedDrops = 0;
+    uint64_t retiredDrops = 0;
+    std::set<int> namedTracks; // threads by -tid, sessions by socket
+    std::string pending; // events formatted since the last write
+
+    void run() {
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        while (!stopping) {
+            wakeup.wait_for(lock, interval);
+            lock.unlock();
+            drain();
+            lock.lock();
+        }
+    }
+
+    void drain() {
+        std::lock_guard<std::mutex> lock(ringMutex);
+        uint64_t drops = retiredDrops;
+        for (size_t i = 0; i < rings.size();) {
+            TraceRing& ring = *rings[i];
+            // Read before draining: once set, nothing more is pushed
+            const bool finished = ring.finished.load(std::memory_order_acquire);
+            if (namedTracks.insert(-static_cast<int>(ring.thread)).second)
+                meta("thread_name", 1, static_cast<int>(ring.thread), "thread " + std::to_string(ring.thread));
+            ring.drain([&](const TraceEvent& e) { write(e, ring.thread); });
+            drops += ring.dropped.load(std::memory_order_relaxed);
+            if (finished) {
+                retiredDrops += ring.dropped.load(std::memory_order_relaxed);
+                rings.erase(rings.begin() + static_cast<std::ptrdiff_t>(i));
+                ++retired;
+            }
+            else ++i;
+        }
+        if (drops != reportedDrops) {
+            reportedDrops = drops;
+            char buf[160];
+            std::snprintf(buf, sizeof buf, "{\"name\":\"dropped spans\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"args\":{\"spans\":%llu}}",
+                static_cast<double>(since(traceClock())) / 1000.0, static_cast<unsigned long long>(drops));
+            emit(buf);
+        }
+        std::fwrite(pending.data(), 1, pending.size(), file);
+        std::fflush(file);
+        pending.clear();
+    }
+
+    void write(const TraceEvent& e, unsigned thread) {
+        const int pid = e.track ? 2 : 1;
+        const int tid = e.track ? e.track : static_cast<int>(thread);
+        if (e.track && namedTracks.insert(e.track).second) meta("thread_name", 2, tid, "socket " + std::to_string(e.track));
+        pending += separator;
+        pending += "{\"name\":\"";
+        pending += e.name;
+        pending += "\",\"ph\":\"X\",\"ts\":";
+        micros(pending, e.start);
+        pending += ",\"dur\":";
+        micros(pending, e.duration);
+        pending += ",\"pid\":";
+        integer(pending, pid);
+        pending += ",\"tid\":";
+        integer(pending, tid);
+        if (e.detail[0]) {
+            pending += ",\"args\":{\"detail\":";
+            quote(pending, e.detail);
+            pending += '}';
+        }
+        pending += '}';
+        separator = ",\n";
+    }
+
+    void meta(const char* what, int pid, int tid, const std::string& name) {
+        std::string m = std::string("{\"name\":\"") + what + "\",\"ph\":\"M\",\"pid\":" + std::to_string(pid) + ",\"tid\":" + std::to_string(tid) + ",\"args\":{\"name\":";
+        quote(m, name);
+        m += "}}";
+        emit(m.c_str());
+    }
+
+    void emit(const char* event) {
+        pending += separator;
+        pending += event;
+        separator = ",\n";
+    }
+
+    // Integer formatting: the writer turns out hundreds of thousands of events a second
+    static void integer(std::string& out, int64_t v) {
+        char buf[24];
+        const auto r = std::to_chars(buf, buf + sizeof buf, v);
+        out.append(buf, r.ptr);
+    }
+
+    // Nanoseconds as microseconds with three decimals, the unit of "ts" and "dur"
+    static void micros(std::string& out, int64_t ns) {
+        if (ns < 0) ns = 0;
+        integer(out, ns / 1000);
+        const int frac = static_cast<int>(ns % 1000);
+        const char digits[4] = { '.', static_cast<char>('0' + frac / 100), static_cast<char>('0' + frac / 10 % 10), static_cast<char>('0' + frac % 10) };
+        out.append(digits, 4);
+    }
+
+    static void quote(std::string& out, std::string_view text) {
+        out += '"';
+        for (const char c : text) {
+            if (c == '"' || c == '\\') out += '\\';
+            if (static_cast<unsigned char>(c) < 0x20) out += ' ';
+            else out += c;
+        }
+        out += '"';
+    }
+};
+
+// Never destroyed, like the metrics registry: threads owned by other statics
+// hand their rings back while the program exits
+inline TraceLog& traceLog() {
+    static TraceLog* log = new TraceLog;
+    return *log;
+}
+
+class ThreadTrace {
+public:
+    ThreadTrace() : ring(traceLog().attach()) {}
+    ~ThreadTrace() { traceLog().detach(ring); }
+    ThreadTrace(const ThreadTrace&) = delete;
+    ThreadTrace& operator=(const ThreadTrace&) = delete;
+
+    TraceRing* const ring;
+};
+
+// This thread's ring, made on its first span
+inline TraceRing& traceRing() {
+    thread_local ThreadTrace mine;
+    return *mine.ring;
+}
+
+//------Spans-------//
+// Records its scope as one complete event. `name` must be a literal; `detail`
+// (a game, a stage) is copied and shows under the span's arguments.
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name, std::string_view detail = {}) : name(traceLog().enabled() ? name : nullptr) {
+        if (!this->name) return;
+        const size_t n = std::min(detail.size(), sizeof this->detail - 1);
+        std::copy_n(detail.data(), n, this->detail);
+        this->detail[n] = '\0';
+        ring = &traceRing();
+        track = sessionContext().track;
+        start = traceClock();
+    }
+    ~TraceSpan() {
+        if (!name) return;
+        const int64_t end = traceClock();
+        TraceLog& log = traceLog();
+        TraceEvent e{ name, log.since(start), end - start, track, {} };
+        std::copy_n(detail, sizeof detail, e.detail);
+        log.record(*ring, e);
+    }
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* const name;
+    TraceRing* ring = nullptr;
+    int track = 0;
+    int64_t start = 0;
+    char detail[sizeof(TraceEvent::detail)];
+};
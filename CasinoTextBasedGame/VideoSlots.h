@@ -0,0 +1,133 @@
+﻿#pragma once
+#include "Main.h"
+#include "SlotsEngine.h"
+#include "VideoSlotsEngine.h"
+#include "GameRegistry.h"
+#include "View.h"
+#include <chrono>
+#include <memory>
+
+// View is ConsoleView or NullView (View.h); see the VideoSlots alias below
+template <typename View = ConsoleView>
+class BasicVideoSlots {
+private:
+    View view;
+    VideoSlotConfig config;
+    std::string configNote; // shown on the first spin if videoslots.cfg exists but is broken
+    std::unique_ptr<VideoSlotEvaluator> evaluator;
+
+    const VideoSlotEvaluator& evaluatorFor(int lines) {
+        if (!evaluator || evaluator->activeLines() != lines) evaluator.reset(new VideoSlotEvaluator(config, lines));
+        return *evaluator;
+    }
+
+    void showGrid(const uint8_t grid[16]) const {
+        view.draw([&](FrameBuffer& out) {
+            std::ostringstream oss;
+            for (int r = 0; r < VideoSlotConfig::rows; ++r) {
+                for (int k = 0; k < VideoSlotConfig::reels; ++k) {
+                    oss << (k ? "  " : "") << config.glyphs[grid[r * VideoSlotConfig::reels + k]];
+                }
+                if (r + 1 < VideoSlotConfig::rows) oss << "\n";
+            }
+            drawAsciiBox(out, oss.str());
+        });
+    }
+
+    Task<void> spinAnimation() const {
+        co_await view.animate(VideoSlotConfig::reels + 1, [](FrameBuffer& out, int k) {
+            out << "Spinning";
+            out.repeat(" .", k);
+            return k < VideoSlotConfig::reels ? 180 : 0;
+        });
+    }
+
+public:
+    // Reels, paylines and pays come from videoslots.cfg in the working directory;
+    // without one the built-in 25-line machine is used
+    BasicVideoSlots() : config(VideoSlotConfig::standard()) {
+        const std::string path = "videoslots.cfg";
+        std::string error;
+        if (std::ifstream(path) && !loadVideoSlotConfig(path, config, error)) {
+            configNote = error + "\nUsing the built-in machine instead.";
+        }
+    }
+
+    Task<void> play(Player& player, CasinoManager& casino) {
+        TraceSpan span("VideoSlots::play");
+        if (!configNote.empty()) {
+            view.box(configNote);
+            configNote.clear();
+        }
+
+        InputSource& input = casino.input;
+        const bool autoPlay = co_await input.readChoice("1) Single spin  2) Auto-spin: ", 1, 2) == 2;
+        const int lines = co_await input.readInt("Paylines to play (1-" + std::to_string(config.lineCount()) + "): ", 1, config.lineCount());
+        const double lineBet = co_await input.readDouble(u8"Bet per line (£1–£50): ", 1, 50);
+        const double bet = lineBet * lines;
+        const VideoSlotEvaluator& eval = evaluatorFor(lines);
+
+        if (autoPlay) {
+            AutoSpinPlan plan = co_await readAutoSpinPlan(input, bet);
+            auto start = std::chrono::steady_clock::now();
+            std::vector<double> multipliers;
+            spinVideoSlotBatch(config, eval, rng(), static_cast<size_t>(plan.spins), multipliers);
+            countMetric(Counter::EvaluatorCalls, multipliers.size());
+            settleAutoSpins(view, player, casino, plan, multipliers, start);
+            co_return;
+        }
+
+        if (!player.canCover(bet)) {
+            view.box(u8"Insufficient funds. Your balance: £", Fixed{ player.getBalance(), 6 });
+            co_return;
+        }
+        player.placeBet(bet);
+        view.box(u8"Bet placed: £", Fixed{ bet, 6 }, " on ", lines, u8" lines\nRemaining balance: £", Fixed{ player.getBalance(), 6 });
+
+        int stops[VideoSlotConfig::reels];
+        for (int k = 0; k < VideoSlotConfig::reels; ++k) stops[k] = randint(0, (int)config.strips[k].size() - 1);
+        alignas(16) uint8_t grid[16];
+        config.fillGrid(stops, grid);
+
+        co_await spinAnimation();
+        showGrid(grid);
+
+        VideoSpinResult res;
+        {
+            PhaseTimer timing(Phase::Evaluate);
+            countMetric(Counter::EvaluatorCalls);
+            res = eval.evaluate(grid);
+        }
+        const double mult = eval.multiplier(res);
+        if (mult > 0.0) {
+            view.draw([&](FrameBuffer& out) {
+                std::ostringstream oss;
+                oss << std::fixed << std::setprecision(2);
+                for (int line = 0; line < lines; ++line) {
+                    if (!((res.winningLines >> line) & 1)) continue;
+                    int sym, run;
+                    const uint32_t pay = eval.linePay(grid, line, sym, run);
+                    oss << "Line " << line + 1 << ": " << run << " x " << config.glyphs[sym] << u8"  £" << pay * lineBet << "\n";
+                }
+                if (res.scatterPay) oss << res.scatters << " x " << config.glyphs[config.scatter] << u8" scatter  £" << res.scatterPay * bet << "\n";
+                oss << "Total pays " << mult << "x your bet.";
+                drawAsciiBox(out, oss.str());
+            });
+            casino.processWin(bet, mult, View::enabled);
+        }
+        else {
+            view.box("No win. Better luck next time.");
+            maybeApplyRandomCurseAfterLoss(player, View::enabled);
+            casino.processLoss(bet, View::enabled);
+        }
+
+        player.regenerateMana();
+        player.decayCurses(View::enabled);
+        player.clearBlessings();
+
+        view.status(player);
+    }
+};
+
+using VideoSlots = BasicVideoSlots<ConsoleView>;
+inline const bool videoSlotsRegistered = registerGame<VideoSlots, BasicVideoSlots<NullView>>({ "Video Slots", "Video Slots (5x3)", 6, AutoPlay });
@@ -0,0 +1,542 @@
+﻿#pragma once
+#include "Main.h"
+#include "JobScheduler.h"
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+
+#if defined(__SSSE3__) || defined(__AVX__)
+#include <tmmintrin.h>
+#define CASINO_SLOTS_SIMD 1
+#endif
+
+//================== Video Slot Config ==================//
+//------5 reels x 3 rows, paylines, wild and scatter-------//
+// Text format (one directive per line, # starts a comment):
+//   symbol <name> <glyph> [wild|scatter]   at most one wild and one scatter
+//   reel <1-5> <name|name*k> ...           stops in strip order
+//   line <TMB x5>                          row on each reel, e.g. TMBMT
+//   pay <name> <x3> <x4> <x5>              left-to-right line pays, x line bet
+//   scatter <count> <mult>                 scatters anywhere, x total bet
+// A line pays for its first non-wild symbol, counting wilds as that symbol,
+// or for its leading wilds alone when the wild's own pay is higher.
+struct VideoSlotConfig {
+    static constexpr int reels = 5;
+    static constexpr int rows = 3;
+    static constexpr int cells = reels * rows;
+    static constexpr int maxLines = 50;
+    static constexpr int maxSymbols = 16;
+
+    std::vector<std::string> names;
+    std::vector<std::string> glyphs;
+    int wild = -1;
+    int scatter = -1;
+    std::vector<uint8_t> strips[reels];
+    std::vector<std::array<uint8_t, reels>> lines; // row (0 top .. 2 bottom) on each reel
+    uint16_t pays[maxSymbols][reels + 1] = {};      // [symbol][run length]
+    uint16_t scatterPays[cells + 1] = {};           // [scatter count]
+
+    int lineCount() const { return static_cast<int>(lines.size()); }
+    int findSymbol(const std::string& name) const {
+        for (size_t i = 0; i < names.size(); ++i) if (names[i] == name) return static_cast<int>(i);
+        return -1;
+    }
+    uint64_t stopCombinations() const {
+        uint64_t n = 1;
+        for (const auto& s : strips) n *= s.size();
+        return n;
+    }
+
+    // Packed grid: cell (row, reel) at byte row * 5 + reel; byte 15 is padding
+    void fillGrid(const int stops[reels], uint8_t grid[16]) const {
+        for (int k = 0; k < reels; ++k) {
+            const size_t len = strips[k].size();
+            for (int r = 0; r < rows; ++r) grid[r * reels + k] = strips[k][(stops[k] + r) % len];
+        }
+        grid[15] = 0xFF;
+    }
+
+    static VideoSlotConfig standard();
+};
+
+// Parses the text format above; on failure returns false with "<source> line N: ..."
+bool parseVideoSlotConfig(std::istream& in, const std::string& source, VideoSlotConfig& out, std::string& error) {
+    VideoSlotConfig cfg;
+    std::vector<std::pair<std::string, int>> reelTokens[VideoSlotConfig::reels]; // token, line
+    std::vector<std::pair<std::vector<std::string>, int>> payLines;
+    std::string line;
+    int lineNo = 0;
+
+    auto fail = [&](int at, const std::string& msg) {
+        error = source + " line " + std::to_string(at) + ": " + msg;
+        return false;
+    };
+
+    while (std::getline(in, line)) {
+        ++lineNo;
+        const size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+        std::istringstream iss(line);
+        std::vector<std::string> tok;
+        for (std::string t; iss >> t; ) tok.push_back(t);
+        if (tok.empty()) continue;
+
+        if (tok[0] == "symbol") {
+            if (tok.size() < 3 || tok.size() > 4) return fail(lineNo, "expected: symbol <name> <glyph> [wild|scatter]");
+            if (cfg.findSymbol(tok[1]) >= 0) return fail(lineNo, "symbol '" + tok[1] + "' declared twice");
+            if (cfg.names.size() >= static_cast<size_t>(VideoSlotConfig::maxSymbols)) return fail(lineNo, "at most 16 symbols");
+            const int id = static_cast<int>(cfg.names.size());
+            if (tok.size() == 4) {
+                if (tok[3] != "wild" && tok[3] != "scatter") return fail(lineNo, "symbol role must be wild or scatter");
+                int& role = (tok[3] == "wild") ? cfg.wild : cfg.scatter;
+                if (role >= 0) return fail(lineNo, "only one " + tok[3] + " symbol is allowed");
+                role = id;
+            }
+            cfg.names.push_back(tok[1]);
+            cfg.glyphs.push_back(tok[2]);
+        }
+        else if (tok[0] == "reel") {
+            const int r = (tok.size() >= 2) ? std::atoi(tok[1].c_str()) : 0;
+            if (r < 1 || r > VideoSlotConfig::reels) return fail(lineNo, "reel number must be 1-5");
+            for (size_t i = 2; i < tok.size(); ++i) reelTokens[r - 1].emplace_back(tok[i], lineNo);
+        }
+        else if (tok[0] == "line") {
+            if (tok.size() != 2 || tok[1].size() != VideoSlotConfig::reels) return fail(lineNo, "expected: line <5 of T/M/B>");
+            if (cfg.lines.size() >= static_cast<size_t>(VideoSlotConfig::maxLines)) return fail(lineNo, "at most 50 paylines");
+            std::array<uint8_t, VideoSlotConfig::reels> rowsOnLine{};
+            for (int k = 0; k < VideoSlotConfig::reels; ++k) {
+                const char c = static_cast<char>(std::toupper(static_cast<unsigned char>(tok[1][k])));
+                if (c != 'T' && c != 'M' && c != 'B') return fail(lineNo, "payline rows are T, M or B");
+                rowsOnLine[k] = static_cast<uint8_t>(c == 'T' ? 0 : c == 'M' ? 1 : 2);
+            }
+            cfg.lines.push_back(rowsOnLine);
+        }
+        else if (tok[0] == "pay" || tok[0] == "scatter") payLines.emplace_back(tok, lineNo);
+        else return fail(lineNo, "unknown directive '" + tok[0] + "'");
+    }
+
+    for (int r = 0; r < VideoSlotConfig::reels; ++r) {
+        for (const auto& entry : reelTokens[r]) {
+            std::string name = entry.first;
+            int repeat = 1;
+            const size_t star = name.find('*');
+            if (star != std::string::npos) {
+                repeat = std::atoi(name.c_str() + star + 1);
+                name.erase(star);
+                if (repeat < 1 || repeat > 1000) return fail(entry.second, "bad repeat count for '" + name + "'");
+            }
+            const int s = cfg.findSymbol(name);
+            if (s < 0) return fail(entry.second, "unknown symbol '" + name + "'");
+            cfg.strips[r].insert(cfg.strips[r].end(), static_cast<size_t>(repeat), static_cast<uint8_t>(s));
+        }
+        if (cfg.strips[r].size() < static_cast<size_t>(VideoSlotConfig::rows))
+            return fail(reelTokens[r].empty() ? lineNo : reelTokens[r].front().second,
+                        "reel " + std::to_string(r + 1) + " needs at least 3 stops");
+    }
+
+    for (const auto& p : payLines) {
+        const auto& tok = p.first;
+        if (tok[0] == "scatter") {
+            if (cfg.scatter < 0) return fail(p.second, "scatter pays need a scatter symbol");
+            const int count = (tok.size() == 3) ? std::atoi(tok[1].c_str()) : 0;
+            const int mult = (tok.size() == 3) ? std::atoi(tok[2].c_str()) : -1;
+            if (count < 1 || count > VideoSlotConfig::cells || mult < 0 || mult > 65535)
+                return fail(p.second, "expected: scatter <count 1-15> <mult>");
+            cfg.scatterPays[count] = static_cast<uint16_t>(mult);
+            continue;
+        }
+        if (tok.size() != 5) return fail(p.second, "expected: pay <name> <x3> <x4> <x5>");
+        const int s = cfg.findSymbol(tok[1]);
+        if (s < 0) return fail(p.second, "unknown symbol '" + tok[1] + "'");
+        if (s == cfg.scatter) return fail(p.second, "scatters pay with the scatter directive");
+        for (int run = 3; run <= VideoSlotConfig::reels; ++run) {
+            const int mult = std::atoi(tok[run - 1].c_str());
+            if (mult < 0 || mult > 65535) return fail(p.second, "line pays must be 0-65535");
+            cfg.pays[s][run] = static_cast<uint16_t>(mult);
+        }
+    }
+
+    if (cfg.names.empty()) return fail(lineNo, "no symbols declared");
+    if (cfg.lines.empty()) return fail(lineNo, "no paylines");
+    out = std::move(cfg);
+    return true;
+}
+
+bool loadVideoSlotConfig(const std::string& path, VideoSlotConfig& out, std::string& error) {
+    std::ifstream in(path);
+    if (!in) { error = "cannot open " + path; return false; }
+    return parseVideoSlotConfig(in, path, out, error);
+}
+
+// Built-in 25-line machine; videoslots.cfg in the working directory replaces it
+VideoSlotConfig VideoSlotConfig::standard() {
+    static const char* text = u8R"(
+symbol cherry  🍒
+symbol lemon   🍋
+symbol orange  🍊
+symbol grape   🍇
+symbol bell    🔔
+symbol diamond 💎
+symbol seven   7️⃣
+symbol joker   🃏 wild
+symbol star    ⭐ scatter
+
+reel 1 cherry lemon orange grape cherry bell lemon diamond cherry orange grape lemon star cherry bell orange joker lemon grape cherry seven orange lemon diamond grape cherry bell lemon orange grape cherry lemon
+reel 2 lemon cherry grape orange bell cherry lemon joker grape diamond orange cherry lemon star grape bell cherry orange seven lemon grape cherry diamond orange lemon bell grape cherry orange lemon cherry grape
+reel 3 orange grape cherry lemon diamond orange bell cherry lemon grape star cherry orange joker lemon grape bell cherry seven orange lemon diamond grape cherry orange bell lemon grape cherry orange lemon cherry
+reel 4 grape lemon orange cherry bell grape diamond lemon cherry orange star grape lemon bell cherry joker orange grape lemon seven cherry diamond orange grape lemon cherry bell orange grape lemon cherry orange
+reel 5 cherry orange lemon grape bell cherry diamond orange lemon star grape cherry bell lemon orange seven grape cherry joker lemon diamond orange cherry grape bell lemon orange cherry grape lemon orange cherry
+
+line MMMMM
+line TTTTT
+line BBBBB
+line TMBMT
+line BMTMB
+line TTMBB
+line BBMTT
+line MTMBM
+line MBMTM
+line TMMMT
+line BMMMB
+line MTTTM
+line MBBBM
+line TMTMT
+line BMBMB
+line MMTMM
+line MMBMM
+line TTBTT
+line BBTBB
+line TBBBT
+line BTTTB
+line TMTBT
+line BMBTB
+line MTBTM
+line MBTBM
+
+pay cherry   8  22  75
+pay lemon    8  22  75
+pay orange  15  40 110
+pay grape   15  45 150
+pay bell    30 110 375
+pay diamond 60 225 750
+pay seven  110 450 3000
+pay joker  150 750 7500
+
+scatter 3 2
+scatter 4 10
+scatter 5 50
+)";
+    VideoSlotConfig cfg;
+    std::istringstream in(text);
+    std::string error;
+    parseVideoSlotConfig(in, "built-in machine", cfg, error);
+    return cfg;
+}
+
+//================== Video Slot Evaluator ==================//
+//------All paylines of a spin from one packed 16-byte grid-------//
+// The SIMD path handles 16 lines per block: one pshufb per reel gathers that
+// reel's symbol for every line, then the first non-wild symbol and the run
+// length come out of byte compares. Only lines with a run of 3+ fall back to
+// a scalar pay lookup, and most spins have none. The scalar path works on
+// 64-bit line sets instead: for each symbol on the grid it ANDs together the
+// lines that show that symbol (or the wild) on each reel.
+struct VideoSpinResult {
+    uint32_t linePay = 0;    // x line bet, summed over winning lines
+    uint32_t scatterPay = 0; // x total bet
+    int scatters = 0;
+    uint64_t winningLines = 0;
+
+    bool operator==(const VideoSpinResult& o) const {
+        return linePay == o.linePay && scatterPay == o.scatterPay && scatters == o.scatters && winningLines == o.winningLines;
+    }
+};
+
+class VideoSlotEvaluator {
+public:
+    static constexpr int blocks = (VideoSlotConfig::maxLines + 15) / 16;
+
+    VideoSlotEvaluator(const VideoSlotConfig& config, int activeLines) : cfg(&config) {
+        active = std::max(1, std::min(activeLines, config.lineCount()));
+        for (int b = 0; b < blocks; ++b)
+            for (int k = 0; k < VideoSlotConfig::reels; ++k)
+                for (int i = 0; i < 16; ++i) {
+                    const int line = b * 16 + i;
+                    gather[b][k][i] = (line < active) ? static_cast<uint8_t>(config.lines[line][k] * VideoSlotConfig::reels + k) : 0x80;
+                }
+        for (int line = 0; line < active; ++line)
+            for (int k = 0; k < VideoSlotConfig::reels; ++k) linesOnCell[k][config.lines[line][k]] |= 1ULL << line;
+        usedBlocks = (active + 15) / 16;
+        for (int b = 0; b < blocks; ++b) {
+            const int n = std::max(0, std::min(16, active - b * 16));
+            validMask[b] = static_cast<uint32_t>((1u << n) - 1);
+        }
+    }
+
+    int activeLines() const { return active; }
+
+    // Return per unit of total bet (total bet = line bet x active lines)
+    double multiplier(const VideoSpinResult& r) const {
+        return (static_cast<double>(r.linePay) + static_cast<double>(r.scatterPay) * active) / active;
+    }
+
+    // Scalar pay for one line; sym/run describe the winning combination
+    uint32_t linePay(const uint8_t grid[16], int line, int& sym, int& run) const {
+        const auto& rowsOnLine = cfg->lines[line];
+        const int w = cfg->wild;
+        int wilds = 0;
+        while (wilds < VideoSlotConfig::reels && grid[rowsOnLine[wilds] * VideoSlotConfig::reels + wilds] == w) ++wilds;
+        sym = grid[rowsOnLine[0] * VideoSlotConfig::reels];
+        for (int k = 1; k < VideoSlotConfig::reels && sym == w; ++k) sym = grid[rowsOnLine[k] * VideoSlotConfig::reels + k];
+        run = 1;
+        while (run < VideoSlotConfig::reels) {
+            const int s = grid[rowsOnLine[run] * VideoSlotConfig::reels + run];
+            if (s != sym && s != w) break;
+            ++run;
+        }
+        uint32_t pay = run >= 3 ? cfg->pays[sym][run] : 0;
+        if (wilds >= 3 && cfg->pays[w][wilds] > pay) {
+            sym = w;
+            run = wilds;
+            pay = cfg->pays[w][wilds];
+        }
+        return pay;
+    }
+
+    VideoSpinResult evaluateScalar(const uint8_t grid[16]) const {
+        VideoSpinResult res;
+        // on[k][s]: active lines whose reel k cell shows symbol s
+        uint64_t on[VideoSlotConfig::reels][VideoSlotConfig::maxSymbols] = {};
+        uint32_t present = 0;
+        for (int k = 0; k < VideoSlotConfig::reels; ++k)
+            for (int r = 0; r < VideoSlotConfig::rows; ++r) {
+                const int s = grid[r * VideoSlotConfig::reels + k];
+                on[k][s] |= linesOnCell[k][r];
+                present |= 1u << s;
+            }
+
+        const int w = cfg->wild;
+        uint64_t wild[VideoSlotConfig::reels] = {};
+        uint64_t wildOpening = 0; // lines that may pay on wilds alone, settled one by one below
+        if (w >= 0) {
+            for (int k = 0; k < VideoSlotConfig::reels; ++k) wild[k] = on[k][w];
+            present &= ~(1u << w);
+            wildOpening = wild[0] & wild[1] & wild[2];
+        }
+        while (present) {
+            const int s = lowestBit(present);
+            present &= present - 1;
+            // Lines whose first non-wild symbol is s, then the run of s-or-wild from reel 1
+            const uint64_t first = on[0][s] | (wild[0] & (on[1][s] | (wild[1] & (on[2][s] | (wild[2] & (on[3][s] | (wild[3] & on[4][s])))))));
+            const uint64_t three = first & (on[0][s] | wild[0]) & (on[1][s] | wild[1]) & (on[2][s] | wild[2]) & ~wildOpening;
+            if (!three) continue;
+            const uint64_t four = three & (on[3][s] | wild[3]);
+            const uint64_t five = four & (on[4][s] | wild[4]);
+            addLinePays(res, s, three & ~four, four & ~five, five);
+        }
+        while (wildOpening) {
+            const int line = lowestBit64(wildOpening);
+            wildOpening &= wildOpening - 1;
+            int sym, run;
+            const uint32_t pay = linePay(grid, line, sym, run);
+            if (pay) { res.linePay += pay; res.winningLines |= 1ULL << line; }
+        }
+        for (int i = 0; i < VideoSlotConfig::cells; ++i) res.scatters += grid[i] == cfg->scatter;
+        res.scatterPay = cfg->scatterPays[res.scatters];
+        return res;
+    }
+
+#ifdef CASINO_SLOTS_SIMD
+    VideoSpinResult evaluateSimd(const uint8_t grid[16]) const {
+        VideoSpinResult res;
+        const __m128i g = _mm_loadu_si128(reinterpret_cast<const __m128i*>(grid));
+        const __m128i wild = _mm_set1_epi8(static_cast<char>(cfg->wild));
+        const __m128i one = _mm_set1_epi8(1);
+
+        for (int b = 0; b < usedBlocks; ++b) {
+            const __m128i* mask = reinterpret_cast<const __m128i*>(gather[b]);
+            const __m128i r0 = _mm_shuffle_epi8(g, _mm_load_si128(mask + 0));
+            const __m128i r1 = _mm_shuffle_epi8(g, _mm_load_si128(mask + 1));
+            const __m128i r2 = _mm_shuffle_epi8(g, _mm_load_si128(mask + 2));
+            const __m128i r3 = _mm_shuffle_epi8(g, _mm_load_si128(mask + 3));
+            const __m128i r4 = _mm_shuffle_epi8(g, _mm_load_si128(mask + 4));
+
+            // First non-wild symbol on each line
+            __m128i sym = r0;
+            sym = select(_mm_cmpeq_epi8(sym, wild), r1, sym);
+            sym = select(_mm_cmpeq_epi8(sym, wild), r2, sym);
+            sym = select(_mm_cmpeq_epi8(sym, wild), r3, sym);
+            sym = select(_mm_cmpeq_epi8(sym, wild), r4, sym);
+
+            // Run length = 1 + number of leading reels that match (0xFF masks count as -1)
+            const __m128i a1 = matches(r1, sym, wild);
+            const __m128i a2 = _mm_and_si128(a1, matches(r2, sym, wild));
+            const __m128i a3 = _mm_and_si128(a2, matches(r3, sym, wild));
+            const __m128i a4 = _mm_and_si128(a3, matches(r4, sym, wild));
+            const __m128i run = _mm_sub_epi8(_mm_sub_epi8(one, _mm_add_epi8(a1, a2)), _mm_add_epi8(a3, a4));
+
+            // a2 is set exactly where the run reaches three reels; lines opening on
+            // three wilds may pay more on the wilds alone and take the scalar path
+            uint32_t wins = static_cast<uint32_t>(_mm_movemask_epi8(a2)) & validMask[b];
+            if (!wins) continue;
+            const __m128i w3 = _mm_and_si128(_mm_cmpeq_epi8(r0, wild), _mm_and_si128(_mm_cmpeq_epi8(r1, wild), _mm_cmpeq_epi8(r2, wild)));
+            const uint32_t wildLines = static_cast<uint32_t>(_mm_movemask_epi8(w3));
+
+            alignas(16) uint8_t syms[16];
+            alignas(16) uint8_t runs[16];
+            _mm_store_si128(reinterpret_cast<__m128i*>(syms), sym);
+            _mm_store_si128(reinterpret_cast<__m128i*>(runs), run);
+            while (wins) {
+                const int i = lowestBit(wins);
+                wins &= wins - 1;
+                int s, r;
+                const uint32_t pay = ((wildLines >> i) & 1) ? linePay(grid, b * 16 + i, s, r) : cfg->pays[syms[i]][runs[i]];
+                if (pay) { res.linePay += pay; res.winningLines |= 1ULL << (b * 16 + i); }
+            }
+        }
+
+        const __m128i scat = _mm_cmpeq_epi8(g, _mm_set1_epi8(static_cast<char>(cfg->scatter)));
+        uint32_t m = static_cast<uint32_t>(_mm_movemask_epi8(scat)) & 0x7FFF;
+        while (m) { m &= m - 1; ++res.scatters; }
+        res.scatterPay = cfg->scatterPays[res.scatters];
+        return res;
+    }
+#endif
+
+    VideoSpinResult evaluate(const uint8_t grid[16]) const {
+#ifdef CASINO_SLOTS_SIMD
+        return evaluateSimd(grid);
+#else
+        return evaluateScalar(grid);
+#endif
+    }
+
+private:
+    const VideoSlotConfig* cfg;
+    int active = 1;
+    int usedBlocks = 1;
+    alignas(16) uint8_t gather[blocks][VideoSlotConfig::reels][16];
+    uint32_t validMask[blocks];
+    uint64_t linesOnCell[VideoSlotConfig::reels][VideoSlotConfig::rows] = {};
+
+    static int lowestBit(uint32_t v) {
+#if defined(_MSC_VER)
+        unsigned long i;
+        _BitScanForward(&i, v);
+        return static_cast<int>(i);
+#else
+        return __builtin_ctz(v);
+#endif
+    }
+    static int lowestBit64(uint64_t v) {
+#if defined(_MSC_VER)
+        unsigned long i;
+        _BitScanForward64(&i, v);
+        return static_cast<int>(i);
+#else
+        return __builtin_ctzll(v);
+#endif
+    }
+    static int popCount(uint64_t v) {
+        int n = 0;
+        for (; v; v &= v - 1) ++n;
+        return n;
+    }
+
+    // Credits lines that ran exactly 3, 4 and 5 reels on symbol s
+    void addLinePays(VideoSpinResult& res, int s, uint64_t three, uint64_t four, uint64_t five) const {
+        const uint64_t runs[3] = { three, four, five };
+        for (int i = 0; i < 3; ++i) {
+            const uint32_t pay = cfg->pays[s][3 + i];
+            if (!pay || !runs[i]) continue;
+            res.linePay += pay * static_cast<uint32_t>(popCount(runs[i]));
+            res.winningLines |= runs[i];
+        }
+    }
+
+#ifdef CASINO_SLOTS_SIMD
+    static __m128i select(__m128i mask, __m128i a, __m128i b) {
+        return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+    }
+    static __m128i matches(__m128i reel, __m128i sym, __m128i wild) {
+        return _mm_or_si128(_mm_cmpeq_epi8(reel, sym), _mm_cmpeq_epi8(reel, wild));
+    }
+#endif
+};
+
+//================== Video Slot RTP ==================//
+//------Exact return over every stop combination, one job per reel 1 stop-------//
+struct VideoSlotRtpReport {
+    uint64_t combinations = 0;
+    uint64_t hits = 0;            // spins paying anything
+    uint64_t scatterHits = 0;     // spins with a paying scatter
+    uint64_t returnedUnits = 0;   // x line bet, scatters converted at lines per total bet
+    int lines = 0;
+
+    double rtp() const { return combinations ? static_cast<double>(returnedUnits) / (static_cast<double>(combinations) * lines) : 0.0; }
+    double hitFrequency() const { return combinations ? static_cast<double>(hits) / combinations : 0.0; }
+};
+
+VideoSlotRtpReport computeVideoSlotRtp(const VideoSlotConfig& cfg, int activeLines, JobScheduler& jobs = jobScheduler()) {
+    const VideoSlotEvaluator eval(cfg, activeLines);
+    VideoSlotRtpReport total = jobs.parallelReduce(cfg.strips[0].size(), 1, VideoSlotRtpReport(),
+        [&cfg, &eval](const JobScheduler::Slice& s) {
+            VideoSlotRtpReport local;
+            alignas(16) uint8_t grid[16];
+            grid[15] = 0xFF;
+            int len[VideoSlotConfig::reels];
+            for (int k = 0; k < VideoSlotConfig::reels; ++k) len[k] = static_cast<int>(cfg.strips[k].size());
+            auto place = [&](int k, int stop) {
+                for (int r = 0; r < VideoSlotConfig::rows; ++r)
+                    grid[r * VideoSlotConfig::reels + k] = cfg.strips[k][(stop + r) % len[k]];
+            };
+
+            place(0, static_cast<int>(s.begin));
+            for (int s1 = 0; s1 < len[1]; ++s1) {
+                place(1, s1);
+                for (int s2 = 0; s2 < len[2]; ++s2) {
+                    place(2, s2);
+                    for (int s3 = 0; s3 < len[3]; ++s3) {
+                        place(3, s3);
+                        for (int s4 = 0; s4 < len[4]; ++s4) {
+                            place(4, s4);
+                            const VideoSpinResult r = eval.evaluate(grid);
+                            const uint64_t units = r.linePay + static_cast<uint64_t>(r.scatterPay) * eval.activeLines();
+                            local.returnedUnits += units;
+                            local.hits += units != 0;
+                            local.scatterHits += r.scatterPay != 0;
+                            ++local.combinations;
+                        }
+                    }
+                }
+            }
+            return local;
+        },
+        [](VideoSlotRtpReport& t, const VideoSlotRtpReport& p) {
+            t.combinations += p.combinations;
+            t.hits += p.hits;
+            t.scatterHits += p.scatterHits;
+            t.returnedUnits += p.returnedUnits;
+        });
+    total.lines = eval.activeLines();
+    return total;
+}
+
+//------Batched spins for auto-play and Monte Carlo-------//
+// out[i] is the spin's return per unit of total bet
+template <typename Gen>
+void spinVideoSlotBatch(const VideoSlotConfig& cfg, const VideoSlotEvaluator& eval, Gen& gen, size_t n, std::vector<double>& out) {
+    std::uniform_int_distribution<int> stop[VideoSlotConfig::reels];
+    for (int k = 0; k < VideoSlotConfig::reels; ++k)
+        stop[k] = std::uniform_int_distribution<int>(0, static_cast<int>(cfg.strips[k].size()) - 1);
+
+    alignas(16) uint8_t grid[16];
+    int stops[VideoSlotConfig::reels];
+    out.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        for (int k = 0; k < VideoSlotConfig::reels; ++k) stops[k] = stop[k](gen);
+        cfg.fillGrid(stops, grid);
+        out[i] = eval.multiplier(eval.evaluate(grid));
+    }
+}
@@ -0,0 +1,88 @@
+﻿#pragma once
+#include "Main.h"
+#include "Animation.h"
+
+//================== Game Views ==================//
+//------Where a game's output goes-------//
+// Games take a view policy and never write to std::cout themselves. A
+// message is handed over as its parts (text, numbers, Fixed) or as a
+// function that composes into the frame buffer, so nothing is formatted
+// until the view decides to draw it.
+//
+// ConsoleView draws to the terminal. NullView has only empty inline members,
+// so a game built with it loses every bit of formatting, std::to_string and
+// string building at compile time, skips animations entirely, and runs as a
+// pure engine. Player and CasinoManager messages follow View::enabled via
+// their announce flags.
+//
+// animate() and pause() are awaited. ConsoleView's are Tasks on the
+// animation scheduler; NullView's never suspend.
+struct ConsoleView {
+    static constexpr bool enabled = true;
+
+    // The parts, concatenated, in a box
+    template <typename... Parts>
+    void box(const Parts&... parts) const {
+        thread_local FrameBuffer text;
+        text.clear();
+        (text << ... << parts);
+        drawAsciiBox(frame(), text.view());
+        frame().present();
+    }
+
+    // The parts as plain text
+    template <typename... Parts>
+    void print(const Parts&... parts) const {
+        FrameBuffer& out = frame();
+        (out << ... << parts);
+        out.present();
+    }
+
+    // The parts on stderr (a server session's own output), for input mistakes
+    template <typename... Parts>
+    void error(const Parts&... parts) const {
+        thread_local FrameBuffer text;
+        text.clear();
+        (text << ... << parts);
+        if (std::string* capture = sessionContext().output) return (void)capture->append(text.view());
+        std::cout.flush();
+        std::cerr.write(text.view().data(), static_cast<std::streamsize>(text.size()));
+    }
+
+    // Anything more involved: compose(FrameBuffer&) draws the frame
+    template <typename Compose>
+    void draw(Compose&& compose) const {
+        compose(frame());
+        frame().present();
+    }
+
+    void cards(const std::vector<Card>& cards, bool hideFirst = false) const {
+        drawCardRow(frame(), cards, hideFirst);
+        frame().present();
+    }
+
+    void status(const Player& player) const { player.showStatus(); }
+
+    void clear() const { terminal().clear(); }
+
+    // drawFrame(FrameBuffer&, int i) composes frame i in place and returns its hold
+    // in ms; runs on the animation scheduler, so a keypress skips to the last frame
+    template <typename DrawFrame>
+    Task<bool> animate(int frameCount, DrawFrame drawFrame) const { return animator().run(frameCount, std::move(drawFrame)); }
+
+    Task<bool> pause(int ms) const { return animator().hold(ms); }
+};
+
+struct NullView {
+    static constexpr bool enabled = false;
+
+    template <typename... Parts> void box(const Parts&...) const {}
+    template <typename... Parts> void print(const Parts&...) const {}
+    template <typename... Parts> void error(const Parts&...) const {}
+    template <typename Compose> void draw(Compose&&) const {}
+    void cards(const std::vector<Card>&, bool = false) const {}
+    void status(const Player&) const {}
+    void clear() const {}
+    template <typename DrawFrame> std::suspend_never animate(int, DrawFrame&&) const { return {}; }
+    std::suspend_never pause(int) const { return {}; }
+};